@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    BypassCrossfade.h
+    Click free, latency matched bypass.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ fades between the processed signal and the dry input when bypass changes.
+ the dry input is delayed by whatever latency the processing reports, so the output lines up
+ and the host's latency compensation stays right whether or not the plugin is bypassed.
+
+ once a fade into bypass has finished, the processing doesn't need to run at all: the output
+ is just the input, delayed if there is latency to match. coming back, the processing runs
+ from rest while the output stays dry until it has filled its own latency, then fades in.
+ */
+template<typename SampleType>
+class BypassCrossfade
+{
+public:
+    static constexpr double fadeSeconds = 0.02;
+
+    void prepare(int numChannels, int maximumBlockSize, int maximumDelaySamples, double sampleRate)
+    {
+        maximumDelay = juce::jmax(0, maximumDelaySamples);
+        delay = juce::jmin(delay, maximumDelay);
+        history.setSize(numChannels, maximumDelay + juce::jmax(1, maximumBlockSize));
+        dry.setSize(numChannels, juce::jmax(1, maximumBlockSize));
+        fadeStep = SampleType(1) / SampleType(juce::jmax(1, juce::roundToInt(sampleRate * fadeSeconds)));
+        reset();
+    }
+
+    //snaps to wherever the fade is heading
+    void reset()
+    {
+        history.clear();
+        writePosition = 0;
+        dryGain = targetGain;
+        warmUp = 0;
+    }
+
+    //the latency the processed signal has, and so the delay the dry one needs
+    void setDelay(int delaySamples)
+    {
+        delaySamples = juce::jlimit(0, maximumDelay, delaySamples);
+
+        if (delaySamples == delay)
+            return;
+
+        //the latency is changing anyway, so the history just starts again
+        delay = delaySamples;
+        history.clear();
+        writePosition = 0;
+    }
+
+    //returns true if the processing starts running again and should be reset first
+    bool setBypassed(bool shouldBeBypassed)
+    {
+        const auto newTarget = shouldBeBypassed ? SampleType(1) : SampleType(0);
+
+        if (newTarget == targetGain)
+            return false;
+
+        const auto wasBypassed = isBypassed();
+        targetGain = newTarget;
+
+        if (! wasBypassed)
+            return false;
+
+        warmUp = delay;
+        return true;
+    }
+
+    //fully bypassed, nothing but the dry signal is heard
+    bool isBypassed() const {return targetGain == SampleType(1) && dryGain == SampleType(1);}
+    bool isFading() const {return dryGain != targetGain;}
+
+    //the most samples pushInput() and mix() take at once
+    size_t getMaximumBlockSize() const {return (size_t)dry.getNumSamples();}
+
+    /*
+     call with the input before it's processed. the history is only kept while there's
+     latency to match, and the dry signal is only kept while fading.
+     */
+    void pushInput(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        jassert(block.getNumSamples() <= getMaximumBlockSize());
+
+        if (delay > 0)
+            writeHistory(block);
+
+        if (! isFading())
+            return;
+
+        const auto numChannels = juce::jmin(block.getNumChannels(), (size_t)dry.getNumChannels());
+        auto dryBlock = juce::dsp::AudioBlock<SampleType>(dry).getSubBlock(0, block.getNumSamples())
+                                                              .getSubsetChannelBlock(0, numChannels);
+
+        if (delay > 0)
+            readHistory(dryBlock);
+        else
+            dryBlock.copyFrom(block.getSubsetChannelBlock(0, numChannels));
+    }
+
+    //call with the processed block pushInput() saw, mixes the dry signal back in
+    void mix(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        if (! isFading())
+            return;
+
+        const auto numSamples = block.getNumSamples();
+        const auto numChannels = juce::jmin(block.getNumChannels(), (size_t)dry.getNumChannels());
+        const auto step = targetGain > dryGain ? fadeStep : -fadeStep;
+        auto gain = dryGain;
+        auto hold = warmUp;
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* out = block.getChannelPointer(channel);
+            auto* in = dry.getReadPointer((int)channel);
+            gain = dryGain;
+            hold = warmUp;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                if (hold > 0)
+                    --hold;
+                else
+                    gain = juce::jlimit(SampleType(0), SampleType(1), gain + step);
+
+                out[i] += (in[i] - out[i]) * gain;
+            }
+        }
+
+        dryGain = gain;
+        warmUp = hold;
+    }
+
+    //fully bypassed: the input becomes the dry signal, in place
+    void processBypassed(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        if (delay == 0 || getMaximumBlockSize() == 0)
+            return;
+
+        for (size_t start = 0; start < block.getNumSamples(); start += getMaximumBlockSize())
+        {
+            auto chunk = block.getSubBlock(start, juce::jmin(getMaximumBlockSize(), block.getNumSamples() - start));
+            writeHistory(chunk);
+            readHistory(chunk);
+        }
+    }
+
+private:
+    void writeHistory(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        const auto length = history.getNumSamples();
+        const auto numSamples = (int)block.getNumSamples();
+        const auto numChannels = juce::jmin((int)block.getNumChannels(), history.getNumChannels());
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* in = block.getChannelPointer((size_t)channel);
+            const auto firstPart = juce::jmin(numSamples, length - writePosition);
+
+            history.copyFrom(channel, writePosition, in, firstPart);
+            history.copyFrom(channel, 0, in + firstPart, numSamples - firstPart);
+        }
+
+        writePosition = (writePosition + numSamples) % length;
+    }
+
+    //the block just written, 'delay' samples ago
+    void readHistory(const juce::dsp::AudioBlock<SampleType>& block) const
+    {
+        const auto length = history.getNumSamples();
+        const auto numSamples = (int)block.getNumSamples();
+        const auto numChannels = juce::jmin((int)block.getNumChannels(), history.getNumChannels());
+        const auto readPosition = ((writePosition - numSamples - delay) % length + length) % length;
+        const auto firstPart = juce::jmin(numSamples, length - readPosition);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* out = block.getChannelPointer((size_t)channel);
+            auto* in = history.getReadPointer(channel);
+
+            std::copy(in + readPosition, in + readPosition + firstPart, out);
+            std::copy(in, in + numSamples - firstPart, out + firstPart);
+        }
+    }
+
+    juce::AudioBuffer<SampleType> history, dry;
+    int writePosition = 0;
+    int maximumDelay = 0;
+    int delay = 0;
+
+    //1 is fully bypassed
+    SampleType dryGain = 0, targetGain = 0;
+    SampleType fadeStep = 1;
+    int warmUp = 0;
+};
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.cpp
+    Threads that share a wide bus's channels during offline renders.
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkerPool.h"
+
+ChannelWorkerPool::~ChannelWorkerPool()
+{
+    release();
+}
+
+void ChannelWorkerPool::prepare(int numWorkers)
+{
+    numWorkers = juce::jmax(0, numWorkers);
+
+    while ((int)workers.size() > numWorkers)
+    {
+        auto& worker = *workers.back();
+        worker.signalThreadShouldExit();
+        worker.start.signal();
+        worker.stopThread(2000);
+        workers.pop_back();
+    }
+
+    while ((int)workers.size() < numWorkers)
+    {
+        workers.push_back(std::make_unique<Worker>(*this));
+        workers.back()->startThread();
+    }
+}
+
+int ChannelWorkerPool::getNumWorkersFor(int numChannels)
+{
+    const auto numGroups = juce::jmin(juce::SystemStats::getNumCpus(), numChannels / minChannelsPerGroup);
+    return juce::jmax(0, numGroups - 1);
+}
+
+void ChannelWorkerPool::run(size_t numChannels, size_t numGroups, void* job, JobCall call)
+{
+    currentJob = job;
+    currentCall = call;
+    currentChannels = numChannels;
+    currentGroups = numGroups;
+
+    //the caller takes a group as well, so one fewer worker than groups
+    const auto numToWake = (int)numGroups - 1;
+
+    nextGroup.store(0);
+    busyWorkers.store(numToWake);
+    finished.reset();
+
+    for (int i = 0; i < numToWake; ++i)
+        workers[(size_t)i]->start.signal();
+
+    runGroups();
+
+    //a worker that found nothing left still has to check in, so none is running when the next job is set
+    finished.wait(-1);
+}
+
+void ChannelWorkerPool::runGroups()
+{
+    const auto numPairs = (currentChannels + 1) / 2;
+
+    for (auto group = nextGroup++; group < currentGroups; group = nextGroup++)
+    {
+        const auto firstPair = group * numPairs / currentGroups;
+        const auto lastPair = (group + 1) * numPairs / currentGroups;
+        const auto first = firstPair * 2;
+        const auto last = juce::jmin(lastPair * 2, currentChannels);
+
+        currentCall(currentJob, first, last - first);
+    }
+}
+
+void ChannelWorkerPool::Worker::run()
+{
+    while (! threadShouldExit())
+    {
+        if (! start.wait(-1) || threadShouldExit())
+            break;
+
+        pool.runGroups();
+
+        if (--pool.busyWorkers == 0)
+            pool.finished.signal();
+    }
+}
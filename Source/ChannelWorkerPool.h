@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.h
+    Threads that share a wide bus's channels during offline renders.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+/*
+ a handful of threads, started by prepare() and kept waiting, that forEachGroup() hands
+ groups of channels to. the calling thread takes a group too and returns once every group
+ is done, so to the caller it's just a slower looking loop.
+ groups are whole channel pairs, at least minChannelsPerGroup channels each, so the cascades'
+ pairs stay together and a group is always worth waking a thread for.
+ the channels of a block never depend on each other, so the output is exactly what one thread
+ would have made. waiting on other threads isn't something to do in realtime though, it's
+ meant for offline renders only.
+ */
+class ChannelWorkerPool
+{
+public:
+    ChannelWorkerPool() = default;
+    ~ChannelWorkerPool();
+
+    //starts or stops threads until there are 'numWorkers'. not from the audio thread.
+    void prepare(int numWorkers);
+    void release() {prepare(0);}
+
+    int getNumWorkers() const {return (int)workers.size();}
+
+    //as many workers as it takes to give every core a group of 'numChannels', none below two groups
+    static int getNumWorkersFor(int numChannels);
+
+    static constexpr int minChannelsPerGroup = 8;
+
+    //runs job(firstChannel, numChannels) over [0, numChannels), see SerialChannels
+    template<typename Job>
+    void forEachGroup(size_t numChannels, Job&& job)
+    {
+        const auto numGroups = juce::jmin(numChannels / (size_t)minChannelsPerGroup, workers.size() + 1);
+
+        if (numGroups <= 1)
+        {
+            job(size_t(0), numChannels);
+            return;
+        }
+
+        using JobType = std::remove_reference_t<Job>;
+
+        run(numChannels, numGroups, const_cast<void*>(static_cast<const void*>(&job)),
+            [](void* context, size_t first, size_t count) {(*static_cast<JobType*>(context))(first, count);});
+    }
+
+private:
+    using JobCall = void (*)(void*, size_t, size_t);
+
+    void run(size_t numChannels, size_t numGroups, void* job, JobCall call);
+
+    //takes groups until there are none left, on whichever thread calls it
+    void runGroups();
+
+    struct Worker : juce::Thread
+    {
+        explicit Worker(ChannelWorkerPool& p) : juce::Thread("Thelassic channel worker"), pool(p) {}
+        void run() override;
+
+        ChannelWorkerPool& pool;
+        juce::WaitableEvent start;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    //the job being run, only written while no worker is busy
+    void* currentJob = nullptr;
+    JobCall currentCall = nullptr;
+    size_t currentChannels = 0, currentGroups = 0;
+
+    std::atomic<size_t> nextGroup {0};
+    std::atomic<int> busyWorkers {0};
+    juce::WaitableEvent finished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelWorkerPool)
+};
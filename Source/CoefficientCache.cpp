@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+    Designed band sections shared by every instance in the process.
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+namespace
+{
+    juce::uint64 getBits(float value)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    juce::uint64 getBits(double value)
+    {
+        juce::uint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+}
+
+bool CoefficientCache::Key::operator==(const Key& other) const
+{
+    return words[0] == other.words[0] && words[1] == other.words[1] && words[2] == other.words[2];
+}
+
+CoefficientCache::Key CoefficientCache::makeKey(const BandSettings& band, double sampleRate)
+{
+    //inputs the type ignores are left at zero, so e.g. every gain of a given cut shares one entry
+    const auto usesGain = band.type == BandType::bell || band.type == BandType::lowShelf || band.type == BandType::highShelf;
+    const auto usesQ = ! band.isCut();
+    const auto usesSlope = band.isCut();
+
+    Key key;
+    key.words[0] = getBits(band.freq) | (usesGain ? getBits(band.gain) << 32 : 0);
+    key.words[1] = (usesQ ? getBits(band.q) : 0)
+                 | juce::uint64(band.type) << 32
+                 | (usesSlope ? juce::uint64(band.slope) << 40 : 0)
+                 | juce::uint64(1) << 48;   //never all zero, so an empty slot can't match
+    key.words[2] = getBits(sampleRate);
+    return key;
+}
+
+size_t CoefficientCache::getHash(const Key& key)
+{
+    //a word at a time through splitmix64's finaliser
+    juce::uint64 hash = 0;
+
+    for (auto word : key.words)
+    {
+        hash ^= word + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+        hash ^= hash >> 31;
+    }
+
+    return size_t(hash);
+}
+
+//==============================================================================
+bool CoefficientCache::read(const Slot& slot, const Key& key, BiquadSection* sections, int& numSections) const
+{
+    const auto before = slot.sequence.load(std::memory_order_acquire);
+
+    if (before == 0 || (before & 1) != 0)
+        return false;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (slot.key[i].load(std::memory_order_relaxed) != key.words[i])
+            return false;
+    }
+
+    numSections = slot.numSections.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        auto* c = slot.coefficients + i * 5;
+        sections[i] = {c[0].load(std::memory_order_relaxed),
+                       c[1].load(std::memory_order_relaxed),
+                       c[2].load(std::memory_order_relaxed),
+                       c[3].load(std::memory_order_relaxed),
+                       c[4].load(std::memory_order_relaxed)};
+    }
+
+    //if a writer got in while we were copying, what we have may be half of each
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == before;
+}
+
+void CoefficientCache::write(Slot& slot, const Key& key, const BiquadSection* sections, int numSections)
+{
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    //somebody else is writing this slot, their result is as good as ours
+    if ((sequence & 1) != 0 || ! slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+        return;
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < 3; ++i)
+        slot.key[i].store(key.words[i], std::memory_order_relaxed);
+
+    slot.numSections.store(numSections, std::memory_order_relaxed);
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        auto* c = slot.coefficients + i * 5;
+        c[0].store(sections[i].b0, std::memory_order_relaxed);
+        c[1].store(sections[i].b1, std::memory_order_relaxed);
+        c[2].store(sections[i].b2, std::memory_order_relaxed);
+        c[3].store(sections[i].a1, std::memory_order_relaxed);
+        c[4].store(sections[i].a2, std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+int CoefficientCache::design(const BandSettings& band, double sampleRate, BiquadSection* sections)
+{
+    const auto key = makeKey(band, sampleRate);
+    const auto first = getHash(key) % numSlots;
+
+    for (size_t probe = 0; probe < probeLength; ++probe)
+    {
+        int numSections = 0;
+
+        if (read(slots[(first + probe) % numSlots], key, sections, numSections))
+        {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return numSections;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+
+    const auto numSections = designBand(band, sampleRate, sections);
+
+    //the first unused slot in reach, otherwise the key's own slot gets replaced
+    auto* target = &slots[first];
+
+    for (size_t probe = 0; probe < probeLength; ++probe)
+    {
+        auto& slot = slots[(first + probe) % numSlots];
+
+        if (slot.sequence.load(std::memory_order_relaxed) == 0)
+        {
+            target = &slot;
+            break;
+        }
+    }
+
+    write(*target, key, sections, numSections);
+    return numSections;
+}
+
+CoefficientCache::Statistics CoefficientCache::getStatistics() const
+{
+    Statistics statistics;
+    statistics.hits = hits.load(std::memory_order_relaxed);
+    statistics.misses = misses.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void CoefficientCache::resetStatistics()
+{
+    hits.store(0, std::memory_order_relaxed);
+    misses.store(0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void designCascade(const ChainSettings& chainSettings, double sampleRate, CascadeDesign& design,
+                   CoefficientCache& cache)
+{
+    design.numSections = 0;
+    design.bandSections.fill(0);
+
+    if (sampleRate <= 0.0)
+        return;
+
+    for (size_t band = 0; band < chainSettings.bands.size(); ++band)
+    {
+        if (chainSettings.bands[band].bypassed)
+            continue;
+
+        design.bandSections[band] = cache.design(chainSettings.bands[band], sampleRate, design.sections.data() + design.numSections);
+        design.numSections += design.bandSections[band];
+    }
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    Designed band sections shared by every instance in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "EQBands.h"
+#include <atomic>
+
+/*
+ a fixed size, lock free table of designed bands, keyed by everything the design depends on.
+ parameters move in fixed steps, so automation passes, preset recalls and instances with the
+ same settings keep asking for the same designs, and only the first asker pays for them.
+
+ each slot is a seqlock: readers never wait, and a writer that finds a slot busy just skips
+ storing its result, so it's safe from the audio thread, the editor and the design thread alike.
+ get at it through juce::SharedResourcePointer<CoefficientCache>.
+ */
+class CoefficientCache
+{
+public:
+    //fills 'sections' with the design for 'band' and returns how many it used
+    int design(const BandSettings& band, double sampleRate, BiquadSection* sections);
+
+    struct Statistics
+    {
+        juce::uint64 hits = 0, misses = 0;
+
+        double getHitRate() const {return hits + misses > 0 ? double(hits) / double(hits + misses) : 0.0;}
+    };
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+    size_t getMemoryUsage() const {return sizeof(*this);}
+
+    static constexpr int numSlots = 2048;
+
+private:
+    //the inputs that matter for the band's type, bit for bit, so different designs never collide
+    struct Key
+    {
+        juce::uint64 words[3] {};
+
+        bool operator==(const Key& other) const;
+    };
+
+    static Key makeKey(const BandSettings& band, double sampleRate);
+    static size_t getHash(const Key& key);
+
+    static constexpr int numCoefficients = maxSectionsPerBand * 5;
+
+    struct Slot
+    {
+        //odd while being written, 0 while it has never been
+        std::atomic<juce::uint32> sequence {0};
+
+        std::atomic<juce::uint64> key[3] {};
+        std::atomic<int> numSections {0};
+        std::atomic<double> coefficients[numCoefficients] {};
+    };
+
+    bool read(const Slot& slot, const Key& key, BiquadSection* sections, int& numSections) const;
+    void write(Slot& slot, const Key& key, const BiquadSection* sections, int numSections);
+
+    //a key only ever lives in one of the few slots after its hash
+    static constexpr int probeLength = 4;
+
+    Slot slots[numSlots];
+
+    std::atomic<juce::uint64> hits {0}, misses {0};
+};
+
+//designCascade(), with every band going through 'cache'
+void designCascade(const ChainSettings& chainSettings, double sampleRate, CascadeDesign& design,
+                   CoefficientCache& cache);
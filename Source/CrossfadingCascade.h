@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    CrossfadingCascade.h
+    Click free switching between cascade topologies.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterCascade.h"
+
+/*
+ a FilterCascade that changes slope, bypass or band count without a click.
+
+ a design with the same sections per band as the running one just updates coefficients.
+ anything else goes to the second, preallocated cascade: bands whose sections didn't change
+ carry their state over, only the changed ones start from rest, and the two run side by
+ side for fadeSeconds while the output crossfades from the old to the new.
+ so at worst a block costs two cascades plus a mix, and a design arriving mid fade waits for
+ the fade to finish rather than starting a third.
+ switching between left/right and mid/side changes what every state means, so that fades with
+ nothing carried over.
+ */
+template<typename SampleType>
+class CrossfadingCascade
+{
+public:
+    static constexpr double fadeSeconds = 0.02;
+
+    void prepare(int numChannels, int maximumBlockSize, double sampleRate)
+    {
+        for (auto& cascade : cascades)
+            cascade.prepare(numChannels);
+
+        fadeBuffer.setSize(numChannels, juce::jmax(1, maximumBlockSize));
+        fadeLength = juce::jmax(1, juce::roundToInt(sampleRate * fadeSeconds));
+
+        active = 0;
+        fadePosition = -1;
+        hasDesign = false;
+        hasPendingDesign = false;
+    }
+
+    void reset()
+    {
+        for (auto& cascade : cascades)
+            cascade.reset();
+
+        //whatever was pending is the newest design, nothing is left to fade from
+        if (isFading())
+            active = 1 - active;
+
+        fadePosition = -1;
+
+        //with every state at rest there's nothing to fade between
+        if (hasPendingDesign)
+        {
+            hasPendingDesign = false;
+            hasDesign = false;
+            setDesign(pendingDesigns[0], pendingDesigns[1], pendingMidSide);
+        }
+    }
+
+    void setDesign(const CascadeDesign& design)
+    {
+        setDesign(design, design, false);
+    }
+
+    /*
+     'first' for the first channel of each pair, 'second' for the other, mid and side if
+     'midSide' is set. they don't need to line up, that's done here.
+     */
+    void setDesign(const CascadeDesign& first, const CascadeDesign& second, bool midSide)
+    {
+        if (isFading())
+        {
+            pendingDesigns[0] = first;
+            pendingDesigns[1] = second;
+            pendingMidSide = midSide;
+            hasPendingDesign = true;
+            return;
+        }
+
+        //what each lane actually runs, before padding, is what decides if it's the same topology
+        const std::array<std::array<int, numBands>, 2> newLaneSections {first.bandSections, second.bandSections};
+        const auto sameLayout = newLaneSections == laneSections && midSide == isMidSide;
+
+        aligned[0] = first;
+        aligned[1] = second;
+        alignDesigns(aligned[0], aligned[1]);
+
+        if (! hasDesign || sameLayout)
+        {
+            cascades[(size_t)active].setDesign(aligned[0], aligned[1]);
+            cascades[(size_t)active].setMidSide(midSide);
+            laneSections = newLaneSections;
+            bandSections = aligned[0].bandSections;
+            isMidSide = midSide;
+            hasDesign = true;
+            return;
+        }
+
+        auto& from = cascades[(size_t)active];
+        auto& to = cascades[(size_t)(1 - active)];
+
+        to.reset();
+        to.setDesign(aligned[0], aligned[1]);
+        to.setMidSide(midSide);
+
+        for (int band = 0, fromSection = 0, toSection = 0; band < numBands && midSide == isMidSide; ++band)
+        {
+            const auto numFrom = bandSections[(size_t)band];
+            const auto numTo = aligned[0].bandSections[(size_t)band];
+            const auto unchanged = laneSections[0][(size_t)band] == newLaneSections[0][(size_t)band]
+                                && laneSections[1][(size_t)band] == newLaneSections[1][(size_t)band];
+
+            if (unchanged && numTo > 0)
+                to.copyState(from, fromSection, toSection, numTo);
+
+            fromSection += numFrom;
+            toSection += numTo;
+        }
+
+        laneSections = newLaneSections;
+        bandSections = aligned[0].bandSections;
+        isMidSide = midSide;
+        fadePosition = 0;
+        ++numCrossfades;
+    }
+
+    //'forEachGroup' is passed on to the cascades, see FilterCascade::process()
+    template<typename ForEachGroup = SerialChannels>
+    void process(const juce::dsp::AudioBlock<SampleType>& block, bool inputIsSilent = false,
+                 ForEachGroup&& forEachGroup = {})
+    {
+        const auto numChannels = juce::jmin(block.getNumChannels(), (size_t)fadeBuffer.getNumChannels());
+        const auto chunkSize = (size_t)fadeBuffer.getNumSamples();
+
+        for (size_t start = 0; start < block.getNumSamples(); )
+        {
+            if (! isFading())
+            {
+                cascades[(size_t)active].process(block.getSubBlock(start, block.getNumSamples() - start), inputIsSilent,
+                                                 forEachGroup);
+                return;
+            }
+
+            const auto numSamples = juce::jmin(chunkSize, block.getNumSamples() - start);
+            auto oldBlock = block.getSubBlock(start, numSamples);
+            auto newBlock = juce::dsp::AudioBlock<SampleType>(fadeBuffer).getSubBlock(0, numSamples)
+                                                                         .getSubsetChannelBlock(0, numChannels);
+
+            newBlock.copyFrom(oldBlock.getSubsetChannelBlock(0, numChannels));
+
+            cascades[(size_t)active].process(oldBlock, inputIsSilent, forEachGroup);
+            cascades[(size_t)(1 - active)].process(newBlock, inputIsSilent, forEachGroup);
+
+            //a linear ramp: both are filtering the same signal, so they're strongly correlated
+            const auto gainStep = SampleType(1) / SampleType(fadeLength);
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                auto* out = oldBlock.getChannelPointer(channel);
+                auto* in = newBlock.getChannelPointer(channel);
+                auto gain = SampleType(fadePosition) * gainStep;
+
+                for (size_t i = 0; i < numSamples; ++i)
+                {
+                    out[i] += (in[i] - out[i]) * juce::jmin(gain, SampleType(1));
+                    gain += gainStep;
+                }
+            }
+
+            fadePosition += (int)numSamples;
+            start += numSamples;
+
+            if (fadePosition >= fadeLength)
+                finishFade();
+        }
+    }
+
+    bool isFading() const {return fadePosition >= 0;}
+    bool isIdle() const {return ! isFading() && cascades[(size_t)active].isIdle();}
+    int getNumSections() const {return cascades[(size_t)active].getNumSections();}
+
+    //how many topology changes have been crossfaded since this was created
+    int getNumCrossfades() const {return numCrossfades;}
+
+private:
+    void finishFade()
+    {
+        active = 1 - active;
+        fadePosition = -1;
+
+        if (hasPendingDesign)
+        {
+            hasPendingDesign = false;
+            setDesign(pendingDesigns[0], pendingDesigns[1], pendingMidSide);
+        }
+    }
+
+    std::array<FilterCascade<SampleType>, 2> cascades;
+    int active = 0;
+
+    //the sections per band of the design being faded to, or running if there's no fade,
+    //per lane as designed and as the cascade runs them once they're lined up
+    std::array<std::array<int, numBands>, 2> laneSections {};
+    std::array<int, numBands> bandSections {};
+    bool isMidSide = false;
+    bool hasDesign = false;
+
+    std::array<CascadeDesign, 2> aligned;
+
+    juce::AudioBuffer<SampleType> fadeBuffer;
+    int fadeLength = 1;
+    int fadePosition = -1;
+
+    std::array<CascadeDesign, 2> pendingDesigns;
+    bool pendingMidSide = false;
+    bool hasPendingDesign = false;
+
+    int numCrossfades = 0;
+};
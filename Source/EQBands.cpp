@@ -0,0 +1,732 @@
+/*
+  ==============================================================================
+
+    EQBands.cpp
+    Band settings, their parameters and the biquad sections they design to.
+
+  ==============================================================================
+*/
+
+#include "EQBands.h"
+#include <complex>
+
+namespace
+{
+    enum class BandParameter
+    {
+        type,
+        freq,
+        gain,
+        q,
+        slope,
+        bypassed,
+        response,
+        steepSlope
+    };
+
+    const char* getSuffix(BandParameter parameter)
+    {
+        switch (parameter)
+        {
+            case BandParameter::type: return "Type";
+            case BandParameter::freq: return "Freq";
+            case BandParameter::gain: return "Gain";
+            case BandParameter::q: return "Q";
+            case BandParameter::slope: return "Slope";
+            case BandParameter::bypassed: return "Bypassed";
+            case BandParameter::response: return "Response";
+            case BandParameter::steepSlope: return "Steep Slope";
+        }
+
+        jassertfalse;
+        return "";
+    }
+
+    //the parameters the original three band layout had, in the order it added them
+    const std::pair<int, BandParameter> legacyParameters[]
+    {
+        {0, BandParameter::freq},
+        {2, BandParameter::freq},
+        {1, BandParameter::freq},
+        {1, BandParameter::gain},
+        {1, BandParameter::q},
+        {0, BandParameter::slope},
+        {2, BandParameter::slope},
+        {0, BandParameter::bypassed},
+        {1, BandParameter::bypassed},
+        {2, BandParameter::bypassed}
+    };
+
+    bool isLegacyParameter(int band, BandParameter parameter)
+    {
+        for (auto& [legacyBand, legacyParameter] : legacyParameters)
+        {
+            if (legacyBand == band && legacyParameter == parameter)
+                return true;
+        }
+
+        return false;
+    }
+
+    BandSettings getDefaultSettings(int band)
+    {
+        BandSettings settings;
+
+        switch (band)
+        {
+            case 0:
+                settings.type = BandType::lowCut;
+                settings.freq = 20.f;
+                break;
+            case 1:
+                settings.type = BandType::bell;
+                settings.freq = 1000.f;
+                settings.q = 0.22f;
+                break;
+            case 2:
+                settings.type = BandType::highCut;
+                settings.freq = 20000.f;
+                break;
+            default:
+                //the extra bands start out bypassed, spread across the spectrum
+                settings.type = BandType::bell;
+                settings.freq = std::round(juce::mapToLog10(float(band - 2) / float(numBands - 2), 20.f, 20000.f));
+                settings.bypassed = true;
+                break;
+        }
+
+        return settings;
+    }
+
+    std::unique_ptr<juce::RangedAudioParameter> makeBandParameter(int band, BandParameter parameter, int channel = 0)
+    {
+        const auto id = getBandParameterID(band, getSuffix(parameter), channel);
+        const auto defaults = getDefaultSettings(band);
+
+        switch (parameter)
+        {
+            case BandParameter::type:
+                return std::make_unique<juce::AudioParameterChoice>(id, id,
+                                                                    juce::StringArray {"Low Cut", "High Cut", "Bell", "Low Shelf", "High Shelf", "Notch"},
+                                                                    (int)defaults.type);
+            case BandParameter::freq:
+                return std::make_unique<juce::AudioParameterFloat>(id, id,
+                                                                   juce::NormalisableRange<float>(20.f, 20000.f, 1.f, band == 0 ? 0.3f : 0.22f),
+                                                                   defaults.freq);
+            case BandParameter::gain:
+                return std::make_unique<juce::AudioParameterFloat>(id, id,
+                                                                   juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                                   defaults.gain);
+            case BandParameter::q:
+                return std::make_unique<juce::AudioParameterFloat>(id, id,
+                                                                   juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                                   defaults.q);
+            case BandParameter::slope:
+            {
+                juce::StringArray stringArray;
+                for( int i = 0; i < numSlopeChoices; ++i )
+                {
+                    juce::String str;
+                    str << (12 + i*12);
+                    str << " db/oct";
+                    stringArray.add(str);
+                }
+
+                return std::make_unique<juce::AudioParameterChoice>(id, id, stringArray, (int)defaults.slope);
+            }
+            case BandParameter::bypassed:
+                return std::make_unique<juce::AudioParameterBool>(id, id, defaults.bypassed);
+            case BandParameter::response:
+                return std::make_unique<juce::AudioParameterChoice>(id, id,
+                                                                    juce::StringArray {"Butterworth", "Chebyshev", "Elliptic"},
+                                                                    (int)CutResponse::butterworth);
+            case BandParameter::steepSlope:
+            {
+                //off leaves the band on its "Slope", anything else is steeper than that goes
+                juce::StringArray stringArray {"Off"};
+                for( int i = numSlopeChoices; i < numSlopes; ++i )
+                {
+                    juce::String str;
+                    str << (12 + i*12);
+                    str << " db/oct";
+                    stringArray.add(str);
+                }
+
+                return std::make_unique<juce::AudioParameterChoice>(id, id, stringArray, 0);
+            }
+        }
+
+        jassertfalse;
+        return nullptr;
+    }
+
+    void normaliseInto(const std::array<double, 6>& coefficients, BiquadSection& section)
+    {
+        //b0, b1, b2, a0, a1, a2
+        const auto a0 = coefficients[3];
+
+        section.b0 = coefficients[0] / a0;
+        section.b1 = coefficients[1] / a0;
+        section.b2 = coefficients[2] / a0;
+        section.a1 = coefficients[4] / a0;
+        section.a2 = coefficients[5] / a0;
+    }
+
+    //==============================================================================
+    /*
+     jacobi elliptic functions by landen's transformation, after orfanidis' "lecture notes on
+     elliptic filter design". arguments are in units of the quarter period K, and converge to
+     machine precision in a handful of steps for any modulus a filter needs.
+     */
+    using Complex = std::complex<double>;
+
+    constexpr int maxLandenSteps = 10;
+
+    //the descending landen moduli of 'k', returns how many
+    int getLandenModuli(double k, double* moduli)
+    {
+        int numModuli = 0;
+
+        while (numModuli < maxLandenSteps && k > 1.0e-15)
+        {
+            k = std::pow(k / (1.0 + std::sqrt(1.0 - k * k)), 2.0);
+            moduli[numModuli++] = k;
+        }
+
+        return numModuli;
+    }
+
+    //cd(u K, k)
+    Complex cd(Complex u, double k)
+    {
+        double moduli[maxLandenSteps];
+        const auto numModuli = getLandenModuli(k, moduli);
+
+        auto w = std::cos(u * juce::MathConstants<double>::halfPi);
+
+        for (auto n = numModuli - 1; n >= 0; --n)
+            w = (1.0 + moduli[n]) * w / (1.0 + moduli[n] * w * w);
+
+        return w;
+    }
+
+    //sn(u K, k), for real u
+    double sn(double u, double k)
+    {
+        return cd(1.0 - u, k).real();
+    }
+
+    //the u for which sn(u K, k) is 'w'
+    Complex inverseSn(Complex w, double k)
+    {
+        double moduli[maxLandenSteps];
+        const auto numModuli = getLandenModuli(k, moduli);
+
+        for (int n = 0; n < numModuli; ++n)
+        {
+            const auto previous = n == 0 ? k : moduli[n - 1];
+            w = w / (1.0 + std::sqrt(1.0 - w * w * previous * previous)) * 2.0 / (1.0 + moduli[n]);
+        }
+
+        //inverse cd, then sn(u) = cd(1 - u)
+        return 1.0 - std::acos(w) / juce::MathConstants<double>::halfPi;
+    }
+
+    //an octave past the cutoff, which is where the slope choices are measured
+    constexpr double stopbandRatio = 2.0;
+
+    //the passband ripple as 1 + epsilon^2, the usual way chebyshev and elliptic designs take it
+    double getRippleEpsilon() {return std::sqrt(std::pow(10.0, cutRippleDb / 10.0) - 1.0);}
+
+    //the modulus k1 = epsilon_p / epsilon_s an elliptic filter of 'order' gets for the transition 1 to stopbandRatio
+    double getEllipticStopbandModulus(int order)
+    {
+        const auto k = 1.0 / stopbandRatio;
+        auto k1 = std::pow(k, (double)order);
+
+        for (int i = 1; i <= order / 2; ++i)
+            k1 *= std::pow(sn((2.0 * i - 1.0) / order, k), 4.0);
+
+        return k1;
+    }
+
+    //how far below the passband an even order cut of 'response' is, stopbandRatio past its cutoff
+    double getAttenuationDb(CutResponse response, int order)
+    {
+        const auto epsilon = getRippleEpsilon();
+
+        switch (response)
+        {
+            case CutResponse::butterworth:
+                return 10.0 * std::log10(1.0 + std::pow(stopbandRatio, 2.0 * order));
+            case CutResponse::chebyshev:
+                return 10.0 * std::log10(1.0 + std::pow(epsilon * std::cosh(order * std::acosh(stopbandRatio)), 2.0));
+            case CutResponse::elliptic:
+                return 10.0 * std::log10(1.0 + std::pow(epsilon / getEllipticStopbandModulus(order), 2.0));
+        }
+
+        jassertfalse;
+        return 0.0;
+    }
+
+    //sections per response and slope. worked out once, the first time any band asks
+    struct CutSectionTable
+    {
+        CutSectionTable()
+        {
+            for (int slope = 0; slope < numSlopes; ++slope)
+            {
+                const auto wantedDb = 12.0 * (slope + 1);
+
+                //butterworth cuts have always stacked one section per slope step
+                const auto butterworthSections = slope + 1;
+                sections[0][(size_t)slope] = butterworthSections;
+
+                //measured from the ripple edge, a gentle chebyshev cut would need more than butterworth.
+                //it's meant to be the cheaper response, so it stops at butterworth's count
+                for (auto response : {CutResponse::chebyshev, CutResponse::elliptic})
+                {
+                    auto numSections = 1;
+
+                    while (numSections < butterworthSections && getAttenuationDb(response, numSections * 2) < wantedDb)
+                        ++numSections;
+
+                    sections[(size_t)response][(size_t)slope] = numSections;
+                }
+            }
+        }
+
+        std::array<std::array<int, numSlopes>, 3> sections {};
+    };
+
+    /*
+     the poles (and for elliptic, zeros) of the lowpass prototype with its passband edge at 1,
+     as second order sections with unity gain at dc. even orders dip by cutRippleDb at dc,
+     so that's taken off the first section, leaving the passband's peaks at 0 db.
+     */
+    void designLowpassPrototype(CutResponse response, int order, AnalogSection* sections)
+    {
+        const auto epsilon = getRippleEpsilon();
+        const auto numSections = order / 2;
+
+        //poles of the elliptic filter, relative to the chebyshev ones below
+        const auto k = 1.0 / stopbandRatio;
+        const auto k1 = response == CutResponse::elliptic ? getEllipticStopbandModulus(order) : 0.0;
+        const auto v0 = response == CutResponse::elliptic ? inverseSn(Complex(0.0, 1.0 / epsilon), k1).imag() / order : 0.0;
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            const auto u = (2.0 * i + 1.0) / order;
+            Complex pole;
+            auto& section = sections[i];
+
+            if (response == CutResponse::elliptic)
+            {
+                pole = Complex(0.0, 1.0) * cd(Complex(u, -v0), k);
+
+                const auto zero = 1.0 / (k * cd(u, k).real());
+                const auto ratio = zero / std::abs(pole);
+                section.n2 = 1.0 / (ratio * ratio);
+            }
+            else
+            {
+                const auto a = std::asinh(1.0 / epsilon) / order;
+                const auto theta = u * juce::MathConstants<double>::halfPi;
+                pole = {-std::sinh(a) * std::sin(theta), std::cosh(a) * std::cos(theta)};
+                section.n2 = 0.0;
+            }
+
+            section.w0 = std::abs(pole);
+            section.k = 2.0 * std::abs(pole.real()) / section.w0;
+            section.n1 = 0.0;
+            section.n0 = 1.0;
+        }
+
+        const auto dcGain = juce::Decibels::decibelsToGain(-cutRippleDb);
+        sections[0].n2 *= dcGain;
+        sections[0].n0 *= dcGain;
+    }
+
+    //the bilinear transform of one analog section, its cutoff prewarped to 'cutoff' (tan(pi f / fs))
+    void bilinear(const AnalogSection& analog, double cutoff, BiquadSection& section)
+    {
+        const auto g = analog.w0 * cutoff;
+        const auto g2 = g * g;
+        const auto a0 = 1.0 + analog.k * g + g2;
+
+        section.b0 = (analog.n2 + analog.n1 * g + analog.n0 * g2) / a0;
+        section.b1 = 2.0 * (analog.n0 * g2 - analog.n2) / a0;
+        section.b2 = (analog.n2 - analog.n1 * g + analog.n0 * g2) / a0;
+        section.a1 = 2.0 * (g2 - 1.0) / a0;
+        section.a2 = (1.0 - analog.k * g + g2) / a0;
+    }
+}
+
+//==============================================================================
+CutResponse BandSettings::getCutResponse() const
+{
+    switch (type)
+    {
+        case BandType::lowCutChebyshev:
+        case BandType::highCutChebyshev:
+            return CutResponse::chebyshev;
+        case BandType::lowCutElliptic:
+        case BandType::highCutElliptic:
+            return CutResponse::elliptic;
+        default:
+            return CutResponse::butterworth;
+    }
+}
+
+int BandSettings::getNumSections() const
+{
+    if (! isCut())
+        return 1;
+
+    static const CutSectionTable table;
+    return table.sections[(size_t)getCutResponse()][(size_t)juce::jlimit(0, numSlopes - 1, (int)slope)];
+}
+
+bool operator==(const BandSettings& a, const BandSettings& b)
+{
+    return a.type == b.type
+        && a.freq == b.freq
+        && a.gain == b.gain
+        && a.q == b.q
+        && a.slope == b.slope
+        && a.bypassed == b.bypassed;
+}
+
+bool operator==(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.bands == b.bands;
+}
+
+juce::String getBandName(int band)
+{
+    switch (band)
+    {
+        case 0: return "Lo Cut";
+        case 1: return "Mid";
+        case 2: return "Hi Cut";
+        default: return "Band " + juce::String(band + 1);
+    }
+}
+
+juce::String getBandParameterID(int band, const char* parameter, int channel)
+{
+    jassert(0 <= channel && channel < numParameterSets);
+    return (channel == 0 ? juce::String() : "Ch" + juce::String(channel + 1) + " ") + getBandName(band) + " " + parameter;
+}
+
+void addLegacyBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    for (auto& [band, parameter] : legacyParameters)
+        layout.add(makeBandParameter(band, parameter));
+}
+
+void addBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout, int channel)
+{
+    for (int band = 0; band < numBands; ++band)
+    {
+        for (auto parameter : {BandParameter::type, BandParameter::freq, BandParameter::gain,
+                               BandParameter::q, BandParameter::slope, BandParameter::bypassed})
+        {
+            if (channel != 0 || ! isLegacyParameter(band, parameter))
+                layout.add(makeBandParameter(band, parameter, channel));
+        }
+    }
+}
+
+void addCutParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    for (int channel = 0; channel < numParameterSets; ++channel)
+    {
+        for (int band = 0; band < numBands; ++band)
+        {
+            layout.add(makeBandParameter(band, BandParameter::response, channel));
+            layout.add(makeBandParameter(band, BandParameter::steepSlope, channel));
+        }
+    }
+}
+
+//==============================================================================
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts, int channel)
+{
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto& parameters = bands[(size_t)band];
+
+        parameters.type = apvts.getRawParameterValue(getBandParameterID(band, "Type", channel));
+        parameters.freq = apvts.getRawParameterValue(getBandParameterID(band, "Freq", channel));
+        parameters.gain = apvts.getRawParameterValue(getBandParameterID(band, "Gain", channel));
+        parameters.q = apvts.getRawParameterValue(getBandParameterID(band, "Q", channel));
+        parameters.slope = apvts.getRawParameterValue(getBandParameterID(band, "Slope", channel));
+        parameters.bypassed = apvts.getRawParameterValue(getBandParameterID(band, "Bypassed", channel));
+        parameters.response = apvts.getRawParameterValue(getBandParameterID(band, "Response", channel));
+        parameters.steepSlope = apvts.getRawParameterValue(getBandParameterID(band, "Steep Slope", channel));
+
+        jassert(parameters.type != nullptr && parameters.freq != nullptr && parameters.gain != nullptr
+                && parameters.q != nullptr && parameters.slope != nullptr && parameters.bypassed != nullptr
+                && parameters.response != nullptr && parameters.steepSlope != nullptr);
+    }
+}
+
+ChainSettings ChainParameters::load() const
+{
+    ChainSettings settings;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto& parameters = bands[(size_t)band];
+        auto& bandSettings = settings.bands[(size_t)band];
+
+        bandSettings.type = static_cast<BandType>((int)parameters.type->load());
+        bandSettings.freq = parameters.freq->load();
+        bandSettings.gain = parameters.gain->load();
+        bandSettings.q = parameters.q->load();
+        bandSettings.slope = static_cast<Slope>((int)parameters.slope->load());
+        bandSettings.bypassed = parameters.bypassed->load() > 0.5f;
+
+        if (const auto steepSlope = (int)parameters.steepSlope->load(); steepSlope > 0)
+            bandSettings.slope = static_cast<Slope>(numSlopeChoices - 1 + steepSlope);
+
+        //only cuts have a response, the rest of the types ignore it
+        const auto response = static_cast<CutResponse>((int)parameters.response->load());
+
+        if (bandSettings.isCut() && response != CutResponse::butterworth)
+        {
+            const auto isLow = bandSettings.type == BandType::lowCut;
+
+            if (response == CutResponse::chebyshev)
+                bandSettings.type = isLow ? BandType::lowCutChebyshev : BandType::highCutChebyshev;
+            else
+                bandSettings.type = isLow ? BandType::lowCutElliptic : BandType::highCutElliptic;
+        }
+    }
+
+    return settings;
+}
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    return ChainParameters(apvts).load();
+}
+
+//==============================================================================
+double BiquadSection::getMagnitudeForFrequency(double frequency, double sampleRate) const
+{
+    const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto cos1 = std::cos(w), sin1 = std::sin(w);
+    const auto cos2 = std::cos(2.0 * w), sin2 = std::sin(2.0 * w);
+
+    const auto numRe = b0 + b1 * cos1 + b2 * cos2;
+    const auto numIm = b1 * sin1 + b2 * sin2;
+    const auto denRe = 1.0 + a1 * cos1 + a2 * cos2;
+    const auto denIm = a1 * sin1 + a2 * sin2;
+
+    return std::sqrt((numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm));
+}
+
+double BiquadSection::getPoleRadius() const
+{
+    //the poles are the roots of z^2 + a1 z + a2
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+    
+    //a complex conjugate pair, whose product (and so squared magnitude) is a2
+    if (discriminant < 0.0)
+        return std::sqrt(a2);
+    
+    const auto root = std::sqrt(discriminant);
+    return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+}
+
+double CascadeDesign::getMagnitudeForFrequency(double frequency, double sampleRate) const
+{
+    double mag = 1.0;
+
+    for (int i = 0; i < numSections; ++i)
+        mag *= sections[(size_t)i].getMagnitudeForFrequency(frequency, sampleRate);
+
+    return mag;
+}
+
+double CascadeDesign::getTailSamples(double decayDb) const
+{
+    double slowestRadius = 0.0;
+    
+    for (int i = 0; i < numSections; ++i)
+        slowestRadius = juce::jmax(slowestRadius, sections[(size_t)i].getPoleRadius());
+    
+    //every section is fir-like, it's done two samples after the input stops
+    if (slowestRadius <= 0.0)
+        return numSections > 0 ? 2.0 : 0.0;
+    
+    //an unstable design never rings out, nothing sensible can be reported for it
+    if (slowestRadius >= 1.0)
+    {
+        jassertfalse;
+        return 0.0;
+    }
+    
+    //r^n = 10^(-decayDb / 20)
+    return std::ceil(-decayDb / 20.0 * std::log(10.0) / std::log(slowestRadius));
+}
+
+void designButterworth(bool isHighPass, double frequency, double sampleRate, int order, BiquadSection* sections)
+{
+    jassert(order >= 2 && order % 2 == 0);
+
+    //bilinear prewarp, shared by every section
+    const auto k = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto n = isHighPass ? k : 1.0 / k;
+    const auto n2 = n * n;
+
+    for (int i = 0; i < order / 2; ++i)
+    {
+        //1 / q of the i'th pole pair on the butterworth circle
+        const auto invQ = 2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (order * 2.0));
+        const auto c1 = 1.0 / (1.0 + n * invQ + n2);
+
+        auto& section = sections[i];
+        section.b0 = c1;
+        section.b1 = isHighPass ? -2.0 * c1 : 2.0 * c1;
+        section.b2 = c1;
+        section.a1 = (isHighPass ? 2.0 * (n2 - 1.0) : 2.0 * (1.0 - n2)) * c1;
+        section.a2 = (1.0 - n * invQ + n2) * c1;
+    }
+}
+
+int designAnalogCut(const BandSettings& band, AnalogSection* sections)
+{
+    jassert(band.isCut());
+
+    const auto numSections = band.getNumSections();
+    const auto response = band.getCutResponse();
+
+    if (response == CutResponse::butterworth)
+    {
+        //the butterworth pole pairs, the same q's designButterworth() uses
+        for (int i = 0; i < numSections; ++i)
+        {
+            sections[i] = {};
+            sections[i].k = 2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (numSections * 4.0));
+        }
+    }
+    else
+    {
+        designLowpassPrototype(response, numSections * 2, sections);
+    }
+
+    //s -> 1 / s turns the lowpass into a highpass with the same edge: w0 inverts, numerator flips
+    if (band.isLowCut())
+    {
+        for (int i = 0; i < numSections; ++i)
+        {
+            sections[i].w0 = 1.0 / sections[i].w0;
+            std::swap(sections[i].n0, sections[i].n2);
+        }
+    }
+
+    return numSections;
+}
+
+int designBand(const BandSettings& band, double sampleRate, BiquadSection* sections)
+{
+    using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<double>;
+
+    //every design needs the centre below nyquist
+    const auto freq = juce::jmin((double)band.freq, sampleRate * 0.49);
+    const auto gain = juce::Decibels::decibelsToGain((double)band.gain);
+    const auto q = (double)band.q;
+
+    switch (band.type)
+    {
+        case BandType::lowCut:
+        case BandType::highCut:
+            designButterworth(band.type == BandType::lowCut, freq, sampleRate, 2 * band.getNumSections(), sections);
+            return band.getNumSections();
+        case BandType::lowCutChebyshev:
+        case BandType::highCutChebyshev:
+        case BandType::lowCutElliptic:
+        case BandType::highCutElliptic:
+        {
+            AnalogSection analog[maxSectionsPerBand];
+            const auto numSections = designAnalogCut(band, analog);
+            const auto cutoff = std::tan(juce::MathConstants<double>::pi * freq / sampleRate);
+
+            for (int i = 0; i < numSections; ++i)
+                bilinear(analog[i], cutoff, sections[i]);
+
+            return numSections;
+        }
+        case BandType::bell:
+            normaliseInto(ArrayCoefficients::makePeakFilter(sampleRate, freq, q, gain), sections[0]);
+            return 1;
+        case BandType::lowShelf:
+            normaliseInto(ArrayCoefficients::makeLowShelf(sampleRate, freq, q, gain), sections[0]);
+            return 1;
+        case BandType::highShelf:
+            normaliseInto(ArrayCoefficients::makeHighShelf(sampleRate, freq, q, gain), sections[0]);
+            return 1;
+        case BandType::notch:
+            normaliseInto(ArrayCoefficients::makeNotch(sampleRate, freq, q), sections[0]);
+            return 1;
+    }
+
+    jassertfalse;
+    return 0;
+}
+
+void designCascade(const ChainSettings& chainSettings, double sampleRate, CascadeDesign& design)
+{
+    design.numSections = 0;
+    design.bandSections.fill(0);
+
+    //nothing to design for before the host has told us the sample rate
+    if (sampleRate <= 0.0)
+        return;
+
+    for (size_t band = 0; band < chainSettings.bands.size(); ++band)
+    {
+        if (chainSettings.bands[band].bypassed)
+            continue;
+
+        design.bandSections[band] = designBand(chainSettings.bands[band], sampleRate, design.sections.data() + design.numSections);
+        design.numSections += design.bandSections[band];
+    }
+}
+
+void alignDesigns(CascadeDesign& first, CascadeDesign& second)
+{
+    std::array<int, numBands> aligned {};
+    auto numSections = 0;
+
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+    {
+        aligned[band] = juce::jmax(first.bandSections[band], second.bandSections[band]);
+        numSections += aligned[band];
+    }
+
+    //back to front, every band only ever moves towards the end, so nothing is overwritten before it's moved
+    for (auto* design : {&first, &second})
+    {
+        auto from = design->numSections, to = numSections;
+
+        for (auto band = numBands - 1; band >= 0; --band)
+        {
+            const auto numOwn = design->bandSections[(size_t)band];
+            const auto numAligned = aligned[(size_t)band];
+
+            from -= numOwn;
+            to -= numAligned;
+
+            auto* sections = design->sections.data();
+            std::copy_backward(sections + from, sections + from + numOwn, sections + to + numOwn);
+            std::fill(sections + to + numOwn, sections + to + numAligned, BiquadSection());
+        }
+
+        design->bandSections = aligned;
+        design->numSections = numSections;
+    }
+}
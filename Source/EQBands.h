@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    EQBands.h
+    Band settings, their parameters and the biquad sections they design to.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+//how many bands the parameter layout, state and engine are generated for
+#ifndef THELASSIC_NUM_BANDS
+ #define THELASSIC_NUM_BANDS 16
+#endif
+
+constexpr int numBands = THELASSIC_NUM_BANDS;
+static_assert(3 <= numBands && numBands <= 16, "the first three bands are the original lo cut, mid and hi cut");
+
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48,
+    Slope_60,
+    Slope_72,
+    Slope_84,
+    Slope_96
+};
+
+constexpr int numSlopes = 8;
+
+/*
+ a choice parameter's normalised value depends on how many choices it has, so growing a list
+ would shift every automated or normalised preset value. the "Slope" parameters keep the
+ original four, and past 48 db/oct a band's "Steep Slope" takes over.
+ */
+constexpr int numSlopeChoices = 4;
+
+/*
+ the "Type" parameters only list the first six. the chebyshev and elliptic cuts are a low or
+ high cut with the band's "Response" parameter set, which ChainParameters folds into the type.
+ */
+enum class BandType
+{
+    lowCut,
+    highCut,
+    bell,
+    lowShelf,
+    highShelf,
+    notch,
+    lowCutChebyshev,
+    highCutChebyshev,
+    lowCutElliptic,
+    highCutElliptic
+};
+
+/*
+ how a cut gets to its slope. butterworth is maximally flat and stacks a section per 12 db/oct.
+ chebyshev and elliptic trade cutRippleDb of passband ripple (and elliptic, stopband ripple
+ too) for a steeper transition, so they need far fewer sections for the same attenuation.
+ */
+enum class CutResponse
+{
+    butterworth,
+    chebyshev,
+    elliptic
+};
+
+constexpr double cutRippleDb = 0.5;
+
+struct BandSettings
+{
+    BandType type { BandType::bell };
+    float freq { 1000.f }, gain { 0.f }, q { 0.71f };
+    Slope slope { Slope::Slope_12 };
+    bool bypassed { false };
+
+    bool isLowCut() const {return type == BandType::lowCut || type == BandType::lowCutChebyshev || type == BandType::lowCutElliptic;}
+    bool isHighCut() const {return type == BandType::highCut || type == BandType::highCutChebyshev || type == BandType::highCutElliptic;}
+    bool isCut() const {return isLowCut() || isHighCut();}
+
+    CutResponse getCutResponse() const;
+
+    /*
+     a butterworth cut needs one section per 12 db/oct. chebyshev and elliptic cuts get the fewest
+     sections that are at least the slope's worth of db down an octave past the cutoff, the
+     cutoff being where their passband ripple ends, but never more than butterworth's.
+     everything else is a single biquad.
+     */
+    int getNumSections() const;
+};
+
+bool operator==(const BandSettings& a, const BandSettings& b);
+inline bool operator!=(const BandSettings& a, const BandSettings& b) {return ! (a == b);}
+
+struct ChainSettings
+{
+    std::array<BandSettings, numBands> bands;
+};
+
+bool operator==(const ChainSettings& a, const ChainSettings& b);
+inline bool operator!=(const ChainSettings& a, const ChainSettings& b) {return ! (a == b);}
+
+//==============================================================================
+/*
+ the first three bands keep the ids of the original lo cut, mid and hi cut, so old sessions
+ and automation still load. the rest are "Band 4" to "Band 16".
+ channel 1 is the second parameter set, for the side or right channel when the channels
+ are set up separately. its ids are channel 0's with "Ch2 " in front.
+ */
+juce::String getBandName(int band);
+juce::String getBandParameterID(int band, const char* parameter, int channel = 0);
+
+constexpr int numParameterSets = 2;
+
+//the original ten band parameters, in their original order so hosts that index parameters still line up
+void addLegacyBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+/*
+ every other band parameter, to go after everything the original layout had.
+ for channel 1 that's all of them, the legacy ones only exist for channel 0.
+ */
+void addBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout, int channel = 0);
+
+//"Response" and "Steep Slope" for every band of both sets, to go at the very end of the layout
+void addCutParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+/*
+ the raw parameter values of every band, looked up once so reading them on the audio thread
+ is just atomic loads.
+ */
+struct ChainParameters
+{
+    explicit ChainParameters(juce::AudioProcessorValueTreeState& apvts, int channel = 0);
+
+    ChainSettings load() const;
+
+private:
+    struct BandParameters
+    {
+        std::atomic<float>* type = nullptr;
+        std::atomic<float>* freq = nullptr;
+        std::atomic<float>* gain = nullptr;
+        std::atomic<float>* q = nullptr;
+        std::atomic<float>* slope = nullptr;
+        std::atomic<float>* bypassed = nullptr;
+        std::atomic<float>* response = nullptr;
+        std::atomic<float>* steepSlope = nullptr;
+    };
+
+    std::array<BandParameters, numBands> bands;
+};
+
+//for callers off the audio thread that don't keep a ChainParameters around
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+
+//==============================================================================
+//normalised (a0 == 1) transposed direct form II biquad
+struct BiquadSection
+{
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+    
+    //magnitude of the slower decaying pole, which is what sets how long the section rings
+    double getPoleRadius() const;
+};
+
+constexpr int maxSectionsPerBand = 8;
+constexpr int maxSections = numBands * maxSectionsPerBand;
+
+/*
+ the sections of every active band, packed back to back in band order.
+ bypassed bands contribute nothing, so an 8 band preset is 8 sections (plus any extra cut stages).
+ */
+struct CascadeDesign
+{
+    std::array<BiquadSection, maxSections> sections;
+    int numSections = 0;
+    
+    //how many of the sections each band has, 0 when it's bypassed
+    std::array<int, numBands> bandSections {};
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+    
+    //samples until the slowest decaying pole of any section has fallen by 'decayDb'
+    double getTailSamples(double decayDb = 120.0) const;
+};
+
+/*
+ the sections of an even order butterworth low or high pass, written straight into 'sections'
+ (order / 2 of them). closed form and allocation free, so it's fine on the audio thread, and
+ gives the same sections juce::dsp::FilterDesign's butterworth methods do.
+ */
+void designButterworth(bool isHighPass, double frequency, double sampleRate, int order, BiquadSection* sections);
+
+/*
+ one second order section of an analog cut with its cutoff at 1 rad/s,
+     H(s) = (n2 s'^2 + n1 s' + n0) / (s'^2 + k s' + 1), where s' = s / w0
+ the biquads get to it through the bilinear transform and the svf stages run it directly,
+ so both engines come out of the same prototype.
+ */
+struct AnalogSection
+{
+    double w0 = 1.0, k = 1.0, n2 = 0.0, n1 = 0.0, n0 = 1.0;
+};
+
+//the analog prototype of any cut, written into 'sections'. returns how many, band.getNumSections()
+int designAnalogCut(const BandSettings& band, AnalogSection* sections);
+
+int designBand(const BandSettings& band, double sampleRate, BiquadSection* sections);
+void designCascade(const ChainSettings& chainSettings, double sampleRate, CascadeDesign& design);
+
+/*
+ pads each band of both designs with pass through sections up to whichever has more, so both
+ end up with the same sections per band and can run side by side, one per lane of a pair.
+ */
+void alignDesigns(CascadeDesign& first, CascadeDesign& second);
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    FFTEngine.cpp
+    The backend interface the analyzer's FFT plans run on.
+
+  ==============================================================================
+*/
+
+#include "FFTEngine.h"
+#include "SimdRealFFT.h"
+
+/*
+ juce::dsp::FFT, which picks up FFTW, IPP or vDSP when the build has them and falls back
+ to its generic scalar fft otherwise. kept as the reference the simd engine is checked against.
+ */
+struct JuceFFTEngine : FFTEngine
+{
+    explicit JuceFFTEngine(int order) : fft(order) {}
+    
+    int getSize() const override {return fft.getSize();}
+    
+    void performFrequencyOnlyForwardTransform(float* data) const override
+    {
+        fft.performFrequencyOnlyForwardTransform(data);
+    }
+    
+    const char* getName() const override {return "juce::dsp::FFT";}
+    
+    //juce doesn't report this, so count the twiddle table its fallback engine allocates
+    size_t getMemoryUsage() const override
+    {
+        return sizeof(*this) + size_t(getSize()) * sizeof(juce::dsp::Complex<float>);
+    }
+    
+private:
+    juce::dsp::FFT fft;
+};
+
+std::unique_ptr<FFTEngine> createFFTEngine(int order, FFTBackend backend)
+{
+    if (backend == FFTBackend::automatic)
+    {
+        //juce only needs replacing when it's running its own fallback fft
+       #if JUCE_MAC || JUCE_IOS || JUCE_DSP_USE_INTEL_MKL || JUCE_DSP_USE_SHARED_FFTW || JUCE_DSP_USE_STATIC_FFTW
+        backend = FFTBackend::juce;
+       #else
+        backend = FFTBackend::simd;
+       #endif
+    }
+    
+    if (backend == FFTBackend::juce)
+        return std::make_unique<JuceFFTEngine>(order);
+    
+    return std::make_unique<SimdRealFFT>(order);
+}
+
+//==============================================================================
+juce::String FFTBenchmarkResult::toString() const
+{
+    juce::String str;
+    str << "juce::dsp::FFT: " << juce::String(juceMicrosecondsPerTransform, 2) << " us, "
+        << simdEngineName << ": " << juce::String(simdMicrosecondsPerTransform, 2) << " us, "
+        << "speedup " << juce::String(juceMicrosecondsPerTransform / juce::jmax(simdMicrosecondsPerTransform, 1.0e-9), 2) << "x, "
+        << "max relative error " << juce::String(maxRelativeError, 8);
+    return str;
+}
+
+FFTBenchmarkResult benchmarkFFTEngines(int order, int numIterations)
+{
+    using namespace juce;
+    
+    auto reference = createFFTEngine(order, FFTBackend::juce);
+    auto simd = createFFTEngine(order, FFTBackend::simd);
+    
+    const auto fftSize = reference->getSize();
+    
+    std::vector<float> input(size_t(fftSize));
+    Random random(0x7e1a551c);
+    for (auto& sample : input)
+        sample = random.nextFloat() * 2.f - 1.f;
+    
+    std::vector<float> referenceData(size_t(fftSize) * 2), simdData(size_t(fftSize) * 2);
+    
+    auto timeEngine = [&](const FFTEngine& engine, std::vector<float>& data)
+    {
+        const auto start = Time::getHighResolutionTicks();
+        
+        for (int i = 0; i < numIterations; ++i)
+        {
+            std::copy(input.begin(), input.end(), data.begin());
+            engine.performFrequencyOnlyForwardTransform(data.data());
+        }
+        
+        const auto elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+        return elapsed * 1.0e6 / jmax(1, numIterations);
+    };
+    
+    FFTBenchmarkResult result;
+    result.simdEngineName = simd->getName();
+    result.juceMicrosecondsPerTransform = timeEngine(*reference, referenceData);
+    result.simdMicrosecondsPerTransform = timeEngine(*simd, simdData);
+    
+    //only the non-negative half is compared, that's all the analyzer reads
+    float peak = 0.f, maxError = 0.f;
+    for (int i = 0; i <= fftSize / 2; ++i)
+    {
+        peak = jmax(peak, referenceData[i]);
+        maxError = jmax(maxError, std::abs(referenceData[i] - simdData[i]));
+    }
+    
+    result.maxRelativeError = peak > 0.f ? maxError / peak : 0.f;
+    return result;
+}
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    FFTEngine.h
+    The backend interface the analyzer's FFT plans run on.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+/*
+ a forward real fft producing magnitudes only, the one transform the analyzer needs.
+ engines are immutable once built and keep no scratch state, so a shared plan can call them
+ from any thread. 'data' must hold 2 * getSize() floats, exactly like juce::dsp::FFT.
+ */
+struct FFTEngine
+{
+    virtual ~FFTEngine() = default;
+    
+    virtual int getSize() const = 0;
+    virtual void performFrequencyOnlyForwardTransform(float* data) const = 0;
+    virtual const char* getName() const = 0;
+    
+    //bytes of tables the engine owns
+    virtual size_t getMemoryUsage() const = 0;
+};
+
+enum class FFTBackend
+{
+    automatic,  //juce when it's backed by vDSP, IPP or FFTW, the simd engine otherwise
+    juce,       //juce::dsp::FFT, the reference implementation
+    simd        //the bundled SimdRealFFT
+};
+
+std::unique_ptr<FFTEngine> createFFTEngine(int order, FFTBackend backend = FFTBackend::automatic);
+
+/*
+ times both backends on the same noise and reports how far the simd output strays from juce's.
+ */
+struct FFTBenchmarkResult
+{
+    juce::String simdEngineName;
+    double juceMicrosecondsPerTransform = 0.0;
+    double simdMicrosecondsPerTransform = 0.0;
+    float maxRelativeError = 0.f;
+    
+    juce::String toString() const;
+};
+
+FFTBenchmarkResult benchmarkFFTEngines(int order, int numIterations);
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    FFTPlanCache.cpp
+    Immutable FFT plans and window tables shared by every analyzer in the process.
+
+  ==============================================================================
+*/
+
+#include "FFTPlanCache.h"
+
+FFTPlan::FFTPlan(FFTOrder order, WindowType windowType) :
+engine(createFFTEngine(order)),
+windowTable(size_t(1) << order)
+{
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(windowTable.data(), windowTable.size(), windowType);
+}
+
+size_t FFTPlan::getMemoryUsage() const
+{
+    return sizeof(*this) + engine->getMemoryUsage() + windowTable.capacity() * sizeof(float);
+}
+
+void FFTPlan::applyWindow(float* samples) const
+{
+    juce::FloatVectorOperations::multiply(samples, windowTable.data(), (int)windowTable.size());
+}
+
+void FFTPlan::performFrequencyOnlyForwardTransform(float* inputOutputData) const
+{
+    engine->performFrequencyOnlyForwardTransform(inputOutputData);
+}
+
+//==============================================================================
+FFTPlanCache::PlanPtr FFTPlanCache::getPlan(FFTOrder order, WindowType windowType)
+{
+    const juce::ScopedLock sl(lock);
+    
+    auto& entry = plans[{ (int)order, (int)windowType }];
+    
+    if (auto plan = entry.lock())
+        return plan;
+    
+    auto plan = std::make_shared<const FFTPlan>(order, windowType);
+    entry = plan;
+    return plan;
+}
+
+int FFTPlanCache::getNumLivePlans()
+{
+    const juce::ScopedLock sl(lock);
+    
+    int numLive = 0;
+    for (auto& [key, plan] : plans)
+    {
+        juce::ignoreUnused(key);
+        if (! plan.expired())
+            ++numLive;
+    }
+    
+    return numLive;
+}
+
+size_t FFTPlanCache::getMemoryUsage()
+{
+    const juce::ScopedLock sl(lock);
+    
+    size_t bytes = 0;
+    for (auto& [key, weakPlan] : plans)
+    {
+        juce::ignoreUnused(key);
+        if (auto plan = weakPlan.lock())
+            bytes += plan->getMemoryUsage();
+    }
+    
+    return bytes;
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    FFTPlanCache.h
+    Immutable FFT plans and window tables shared by every analyzer in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FFTEngine.h"
+#include <map>
+#include <memory>
+
+enum FFTOrder
+{
+    order1024 = 10,
+    order2048 = 11,
+    order4096 = 12,
+    order8192 = 13
+};
+
+using WindowType = juce::dsp::WindowingFunction<float>::WindowingMethod;
+
+/*
+ an fft engine and its window table. built once and never modified, so any number of
+ analyzers can use the same plan.
+ */
+struct FFTPlan
+{
+    FFTPlan(FFTOrder order, WindowType windowType);
+    
+    int getSize() const {return engine->getSize();}
+    const char* getEngineName() const {return engine->getName();}
+    size_t getMemoryUsage() const;
+    
+    void applyWindow(float* samples) const;
+    void performFrequencyOnlyForwardTransform(float* inputOutputData) const;
+    
+private:
+    std::unique_ptr<FFTEngine> engine;
+    std::vector<float> windowTable;
+    
+    JUCE_DECLARE_NON_COPYABLE(FFTPlan)
+};
+
+/*
+ reference-counted plans keyed by fft order and window type.
+ the cache only holds weak references, so a plan lives exactly as long as somebody uses it.
+ get at it through juce::SharedResourcePointer<FFTPlanCache>.
+ */
+class FFTPlanCache
+{
+public:
+    using PlanPtr = std::shared_ptr<const FFTPlan>;
+    
+    PlanPtr getPlan(FFTOrder order, WindowType windowType);
+    
+    int getNumLivePlans();
+    
+    //bytes held by every live plan, paid once per process however many instances use them
+    size_t getMemoryUsage();
+    
+private:
+    juce::CriticalSection lock;
+    std::map<std::pair<int, int>, std::weak_ptr<const FFTPlan>> plans;
+};
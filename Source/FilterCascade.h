@@ -0,0 +1,572 @@
+/*
+  ==============================================================================
+
+    FilterCascade.h
+    The biquad engine every band runs on.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "EQBands.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+ #define THELASSIC_CASCADE_SSE 1
+#else
+ #define THELASSIC_CASCADE_SSE 0
+#endif
+
+#if JUCE_ARM && (defined (__aarch64__) || defined (_M_ARM64))
+ #include <arm_neon.h>
+ #define THELASSIC_CASCADE_NEON 1
+#else
+ #define THELASSIC_CASCADE_NEON 0
+#endif
+
+/*
+ two channels side by side in one register, one lane each.
+ a biquad is bound by the latency of its feedback, not by arithmetic, so running left and
+ right through the same instructions costs about what one channel does.
+ each provides Vec, load and store of two adjacent samples, broadcast, add, sub and mul.
+ */
+namespace CascadeLanes
+{
+    template<typename SampleType>
+    struct Scalar
+    {
+        struct Vec { SampleType a, b; };
+
+        static Vec load(const SampleType* p) {return {p[0], p[1]};}
+        static void store(SampleType* p, Vec v) {p[0] = v.a; p[1] = v.b;}
+        static Vec broadcast(SampleType x) {return {x, x};}
+        static Vec add(Vec x, Vec y) {return {x.a + y.a, x.b + y.b};}
+        static Vec sub(Vec x, Vec y) {return {x.a - y.a, x.b - y.b};}
+        static Vec mul(Vec x, Vec y) {return {x.a * y.a, x.b * y.b};}
+    };
+
+   #if THELASSIC_CASCADE_SSE
+    struct SSEDouble
+    {
+        using Vec = __m128d;
+
+        static Vec load(const double* p) {return _mm_loadu_pd(p);}
+        static void store(double* p, Vec v) {_mm_storeu_pd(p, v);}
+        static Vec broadcast(double x) {return _mm_set1_pd(x);}
+        static Vec add(Vec x, Vec y) {return _mm_add_pd(x, y);}
+        static Vec sub(Vec x, Vec y) {return _mm_sub_pd(x, y);}
+        static Vec mul(Vec x, Vec y) {return _mm_mul_pd(x, y);}
+    };
+
+    //the low two lanes of an sse register, moved in and out as one 64 bit value
+    struct SSEFloat
+    {
+        using Vec = __m128;
+
+        static Vec load(const float* p) {return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p)));}
+        static void store(float* p, Vec v) {_mm_store_sd(reinterpret_cast<double*>(p), _mm_castps_pd(v));}
+        static Vec broadcast(float x) {return _mm_set1_ps(x);}
+        static Vec add(Vec x, Vec y) {return _mm_add_ps(x, y);}
+        static Vec sub(Vec x, Vec y) {return _mm_sub_ps(x, y);}
+        static Vec mul(Vec x, Vec y) {return _mm_mul_ps(x, y);}
+    };
+   #endif
+
+   #if THELASSIC_CASCADE_NEON
+    struct NeonDouble
+    {
+        using Vec = float64x2_t;
+
+        static Vec load(const double* p) {return vld1q_f64(p);}
+        static void store(double* p, Vec v) {vst1q_f64(p, v);}
+        static Vec broadcast(double x) {return vdupq_n_f64(x);}
+        static Vec add(Vec x, Vec y) {return vaddq_f64(x, y);}
+        static Vec sub(Vec x, Vec y) {return vsubq_f64(x, y);}
+        static Vec mul(Vec x, Vec y) {return vmulq_f64(x, y);}
+    };
+
+    struct NeonFloat
+    {
+        using Vec = float32x2_t;
+
+        static Vec load(const float* p) {return vld1_f32(p);}
+        static void store(float* p, Vec v) {vst1_f32(p, v);}
+        static Vec broadcast(float x) {return vdup_n_f32(x);}
+        static Vec add(Vec x, Vec y) {return vadd_f32(x, y);}
+        static Vec sub(Vec x, Vec y) {return vsub_f32(x, y);}
+        static Vec mul(Vec x, Vec y) {return vmul_f32(x, y);}
+    };
+   #endif
+
+    template<typename SampleType>
+    struct Best { using Type = Scalar<SampleType>; };
+
+   #if THELASSIC_CASCADE_SSE
+    template<> struct Best<float> { using Type = SSEFloat; };
+    template<> struct Best<double> { using Type = SSEDouble; };
+   #elif THELASSIC_CASCADE_NEON
+    template<> struct Best<float> { using Type = NeonFloat; };
+    template<> struct Best<double> { using Type = NeonDouble; };
+   #endif
+}
+
+//anything this far below full scale is treated as digital silence, about -180 dB
+template<typename SampleType>
+constexpr SampleType silenceThreshold = SampleType(1.0e-9);
+
+//true if every sample of 'block' is below silenceThreshold. stops at the first one that isn't.
+template<typename SampleType>
+bool isSilent(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* data = block.getChannelPointer(channel);
+
+        for (size_t i = 0; i < block.getNumSamples(); ++i)
+        {
+            if (std::abs(data[i]) >= silenceThreshold<SampleType>)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ the engines' process() calls take one of these to go over their channels: it's handed the
+ number of channels and a job(firstChannel, numChannels), and runs the job over all of them.
+ this one does it in one go, ChannelWorkerPool splits them up between threads. splits only
+ fall on even channels so pairs stay together.
+ */
+struct SerialChannels
+{
+    template<typename Job>
+    void operator()(size_t numChannels, Job&& job) const {job(size_t(0), numChannels);}
+};
+
+//the first two channels of 'block' from left and right to mid and side, in place
+template<typename SampleType>
+void encodeMidSide(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    if (block.getNumChannels() < 2)
+        return;
+
+    auto* left = block.getChannelPointer(0);
+    auto* right = block.getChannelPointer(1);
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i)
+    {
+        const auto mid = (left[i] + right[i]) * SampleType(0.5);
+        right[i] = (left[i] - right[i]) * SampleType(0.5);
+        left[i] = mid;
+    }
+}
+
+//and back again
+template<typename SampleType>
+void decodeMidSide(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    if (block.getNumChannels() < 2)
+        return;
+
+    auto* mid = block.getChannelPointer(0);
+    auto* side = block.getChannelPointer(1);
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i)
+    {
+        const auto left = mid[i] + side[i];
+        side[i] = mid[i] - side[i];
+        mid[i] = left;
+    }
+}
+
+/*
+ runs a CascadeDesign over every channel of a block.
+ coefficients are stored structure-of-arrays and only for the active sections, so the
+ cost follows the number of sections actually designed, not the number of bands there are.
+ channels go through in pairs, interleaved a chunk at a time so each sample pair is one
+ register. an odd channel out runs on its own.
+ the sections run in groups of up to maxKernelSections through kernels instantiated per group
+ size, so each sample goes through the whole group with every coefficient and state in
+ registers and the section loop unrolled. the sections' recursions are independent of each
+ other within a sample, so they overlap instead of each waiting on its own feedback.
+ which kernels run is worked out once per setDesign(), not per block.
+ float and double run the same code, the double path is what 64 bit hosts get natively.
+
+ each lane has its own coefficients, loaded once per block like the state, so a pair can run
+ two different designs (mid and side, or left and right) for what one costs. in mid/side mode
+ the pair is encoded as it's interleaved and decoded as it's written back.
+ on a bus wider than stereo that's only the first pair, every other channel runs the first design.
+ */
+template<typename SampleType>
+class FilterCascade
+{
+public:
+    void prepare(int numChannels)
+    {
+        channels.resize((size_t)numChannels);
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& channel : channels)
+        {
+            channel.s1.fill(SampleType(0));
+            channel.s2.fill(SampleType(0));
+        }
+
+        idle = false;
+    }
+
+    //state is kept, so changing coefficients of the same sections is seamless
+    void setDesign(const CascadeDesign& design)
+    {
+        setDesign(design, design);
+    }
+
+    /*
+     'first' runs on the first channel of each pair (and any odd one out), 'second' on the other.
+     both need the same sections per band, see alignDesigns().
+     */
+    void setDesign(const CascadeDesign& first, const CascadeDesign& second)
+    {
+        jassert(first.bandSections == second.bandSections);
+        numSections = first.numSections;
+
+        for (size_t i = 0; i < (size_t)numSections; ++i)
+        {
+            for (size_t lane = 0; lane < 2; ++lane)
+            {
+                lanePairs[0].set(i, lane, (lane == 0 ? first : second).sections[i]);
+                lanePairs[1].set(i, lane, first.sections[i]);
+            }
+        }
+
+        planGroups();
+    }
+
+    //pairs go through as (l + r) / 2 and (l - r) / 2, and come back as l and r
+    void setMidSide(bool shouldBeMidSide) {midSide = shouldBeMidSide;}
+    bool isMidSide() const {return midSide;}
+
+    //the most sections one kernel runs, longer cascades go through in groups of about equal size
+    static constexpr int maxKernelSections = 8;
+
+    int getNumSections() const {return numSections;}
+
+    //carries sections [fromSection, fromSection + count) of 'other' over to [toSection, toSection + count) of this one
+    void copyState(const FilterCascade& other, int fromSection, int toSection, int count)
+    {
+        const auto numChannels = juce::jmin(channels.size(), other.channels.size());
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                channels[channel].s1[(size_t)(toSection + i)] = other.channels[channel].s1[(size_t)(fromSection + i)];
+                channels[channel].s2[(size_t)(toSection + i)] = other.channels[channel].s2[(size_t)(fromSection + i)];
+            }
+        }
+
+        idle = false;
+    }
+
+    /*
+     'inputIsSilent' lets the cascade stop working once its input goes quiet. it keeps running
+     while the filters ring out, then zeroes its state and leaves every further silent block
+     untouched until real input comes back.
+     'forEachGroup' decides how the channels are gone over, see SerialChannels. channels never
+     depend on each other, so however they're split the output is the same.
+     */
+    template<typename ForEachGroup = SerialChannels>
+    void process(const juce::dsp::AudioBlock<SampleType>& block, bool inputIsSilent = false,
+                 ForEachGroup&& forEachGroup = {})
+    {
+        if (! inputIsSilent)
+            idle = false;
+        else if (idle)
+            return;
+
+        //every band bypassed: the output is the input, so don't even touch it
+        if (numSections == 0)
+            return;
+
+        forEachGroup(juce::jmin(block.getNumChannels(), channels.size()), [this, &block](size_t first, size_t count)
+        {
+            processChannels(block, first, count);
+        });
+
+        //zeroing the state once it's inaudible is also what keeps it from ever going denormal
+        if (inputIsSilent && hasRungOut())
+        {
+            reset();
+            idle = true;
+        }
+    }
+
+    //true while silent input is being skipped
+    bool isIdle() const {return idle;}
+
+private:
+    struct ChannelState
+    {
+        std::array<SampleType, maxSections> s1 {}, s2 {};
+    };
+
+    bool hasRungOut() const
+    {
+        for (auto& channel : channels)
+        {
+            for (int section = 0; section < numSections; ++section)
+            {
+                if (std::abs(channel.s1[(size_t)section]) >= silenceThreshold<SampleType>
+                 || std::abs(channel.s2[(size_t)section]) >= silenceThreshold<SampleType>)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    //lane pairs, section i's coefficients for the first lane at [i * 2] and the second at [i * 2 + 1]
+    struct LanePairs
+    {
+        std::array<SampleType, maxSections * 2> b0 {}, b1 {}, b2 {}, a1 {}, a2 {};
+
+        void set(size_t section, size_t lane, const BiquadSection& coefficients)
+        {
+            b0[section * 2 + lane] = (SampleType)coefficients.b0;
+            b1[section * 2 + lane] = (SampleType)coefficients.b1;
+            b2[section * 2 + lane] = (SampleType)coefficients.b2;
+            a1[section * 2 + lane] = (SampleType)coefficients.a1;
+            a2[section * 2 + lane] = (SampleType)coefficients.a2;
+        }
+    };
+
+    //==============================================================================
+    using SingleKernel = void (FilterCascade::*)(int, SampleType*, size_t, ChannelState&) const;
+    using PairKernel = void (FilterCascade::*)(int, const LanePairs&, SampleType*, size_t,
+                                               ChannelState&, ChannelState&) const;
+
+    struct Group
+    {
+        int first = 0;
+        SingleKernel single = nullptr;
+        PairKernel pair = nullptr;
+    };
+
+    template<size_t... Index>
+    static std::array<Group, sizeof...(Index)> makeKernelTable(std::index_sequence<Index...>)
+    {
+        return {{ {0, &FilterCascade::processSingleGroup<int(Index) + 1>, &FilterCascade::processPairGroup<int(Index) + 1>}... }};
+    }
+
+    void planGroups()
+    {
+        static const auto kernels = makeKernelTable(std::make_index_sequence<maxKernelSections>());
+
+        numGroups = (numSections + maxKernelSections - 1) / maxKernelSections;
+
+        for (int group = 0, first = 0; group < numGroups; ++group)
+        {
+            //spread the sections evenly, 22 goes as 8 7 7 rather than 8 8 6
+            const auto size = (numSections - first) / (numGroups - group)
+                            + ((numSections - first) % (numGroups - group) != 0 ? 1 : 0);
+
+            groups[(size_t)group] = kernels[(size_t)(size - 1)];
+            groups[(size_t)group].first = first;
+            first += size;
+        }
+    }
+
+    template<int NumSections>
+    void processSingleGroup(int first, SampleType* data, size_t numSamples, ChannelState& state) const
+    {
+        SampleType cb0[NumSections], cb1[NumSections], cb2[NumSections], ca1[NumSections], ca2[NumSections];
+        SampleType z1[NumSections], z2[NumSections];
+
+        for (int s = 0; s < NumSections; ++s)
+        {
+            const auto section = (size_t)(first + s);
+            auto& c = lanePairs[0];
+            cb0[s] = c.b0[section * 2]; cb1[s] = c.b1[section * 2]; cb2[s] = c.b2[section * 2];
+            ca1[s] = c.a1[section * 2]; ca2[s] = c.a2[section * 2];
+            z1[s] = state.s1[section]; z2[s] = state.s2[section];
+        }
+
+        //transposed direct form II, section after section within each sample
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto x = data[i];
+
+            for (int s = 0; s < NumSections; ++s)
+            {
+                const auto y = cb0[s] * x + z1[s];
+                z1[s] = cb1[s] * x - ca1[s] * y + z2[s];
+                z2[s] = cb2[s] * x - ca2[s] * y;
+                x = y;
+            }
+
+            data[i] = x;
+        }
+
+        for (int s = 0; s < NumSections; ++s)
+        {
+            state.s1[(size_t)(first + s)] = z1[s];
+            state.s2[(size_t)(first + s)] = z2[s];
+        }
+    }
+
+    //exactly the same operations as processSingleGroup, on both lanes at once
+    template<int NumSections>
+    void processPairGroup(int first, const LanePairs& c, SampleType* interleaved, size_t numSamples,
+                          ChannelState& firstState, ChannelState& secondState) const
+    {
+        using Lanes = typename CascadeLanes::Best<SampleType>::Type;
+        using Vec = typename Lanes::Vec;
+
+        Vec cb0[NumSections], cb1[NumSections], cb2[NumSections], ca1[NumSections], ca2[NumSections];
+        Vec z1[NumSections], z2[NumSections];
+        alignas(16) SampleType pair[2];
+
+        for (int s = 0; s < NumSections; ++s)
+        {
+            const auto section = (size_t)(first + s);
+            cb0[s] = Lanes::load(c.b0.data() + section * 2); cb1[s] = Lanes::load(c.b1.data() + section * 2);
+            cb2[s] = Lanes::load(c.b2.data() + section * 2);
+            ca1[s] = Lanes::load(c.a1.data() + section * 2); ca2[s] = Lanes::load(c.a2.data() + section * 2);
+
+            pair[0] = firstState.s1[section]; pair[1] = secondState.s1[section];
+            z1[s] = Lanes::load(pair);
+            pair[0] = firstState.s2[section]; pair[1] = secondState.s2[section];
+            z2[s] = Lanes::load(pair);
+        }
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto x = Lanes::load(interleaved + i * 2);
+
+            for (int s = 0; s < NumSections; ++s)
+            {
+                const auto y = Lanes::add(Lanes::mul(cb0[s], x), z1[s]);
+                z1[s] = Lanes::add(Lanes::sub(Lanes::mul(cb1[s], x), Lanes::mul(ca1[s], y)), z2[s]);
+                z2[s] = Lanes::sub(Lanes::mul(cb2[s], x), Lanes::mul(ca2[s], y));
+                x = y;
+            }
+
+            Lanes::store(interleaved + i * 2, x);
+        }
+
+        for (int s = 0; s < NumSections; ++s)
+        {
+            const auto section = (size_t)(first + s);
+
+            Lanes::store(pair, z1[s]);
+            firstState.s1[section] = pair[0]; secondState.s1[section] = pair[1];
+            Lanes::store(pair, z2[s]);
+            firstState.s2[section] = pair[0]; secondState.s2[section] = pair[1];
+        }
+    }
+
+    //channels [first, first + count), 'first' has to be the first of a pair
+    void processChannels(const juce::dsp::AudioBlock<SampleType>& block, size_t first, size_t count)
+    {
+        jassert(first % 2 == 0);
+
+        const auto numSamples = block.getNumSamples();
+        const auto last = first + count;
+        auto channel = first;
+
+        for (; channel + 1 < last; channel += 2)
+        {
+            const auto isFirstPair = channel == 0;
+
+            processPair(isFirstPair ? lanePairs[0] : lanePairs[1], midSide && isFirstPair,
+                        block.getChannelPointer(channel), block.getChannelPointer(channel + 1),
+                        channels[channel], channels[channel + 1],
+                        numSamples);
+        }
+
+        for (; channel < last; ++channel)
+            processSingle(block.getChannelPointer(channel), channels[channel], numSamples);
+    }
+
+    void processSingle(SampleType* data, ChannelState& state, size_t numSamples)
+    {
+        for (int group = 0; group < numGroups; ++group)
+        {
+            auto& g = groups[(size_t)group];
+            (this->*g.single)(g.first, data, numSamples, state);
+        }
+    }
+
+    void processPair(const LanePairs& coefficients, bool encodeMidSide,
+                     SampleType* first, SampleType* second,
+                     ChannelState& firstState, ChannelState& secondState,
+                     size_t numSamples)
+    {
+        //small enough to live on the stack, big enough that the interleave is noise
+        constexpr size_t chunkSize = 64;
+        alignas(16) SampleType interleaved[chunkSize * 2];
+
+        for (size_t start = 0; start < numSamples; start += chunkSize)
+        {
+            const auto numInChunk = juce::jmin(chunkSize, numSamples - start);
+
+            if (encodeMidSide)
+            {
+                for (size_t i = 0; i < numInChunk; ++i)
+                {
+                    interleaved[i * 2] = (first[start + i] + second[start + i]) * SampleType(0.5);
+                    interleaved[i * 2 + 1] = (first[start + i] - second[start + i]) * SampleType(0.5);
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < numInChunk; ++i)
+                {
+                    interleaved[i * 2] = first[start + i];
+                    interleaved[i * 2 + 1] = second[start + i];
+                }
+            }
+
+            for (int group = 0; group < numGroups; ++group)
+            {
+                auto& g = groups[(size_t)group];
+                (this->*g.pair)(g.first, coefficients, interleaved, numInChunk, firstState, secondState);
+            }
+
+            if (encodeMidSide)
+            {
+                for (size_t i = 0; i < numInChunk; ++i)
+                {
+                    first[start + i] = interleaved[i * 2] + interleaved[i * 2 + 1];
+                    second[start + i] = interleaved[i * 2] - interleaved[i * 2 + 1];
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < numInChunk; ++i)
+                {
+                    first[start + i] = interleaved[i * 2];
+                    second[start + i] = interleaved[i * 2 + 1];
+                }
+            }
+        }
+    }
+
+    int numSections = 0;
+    bool idle = false;
+    bool midSide = false;
+
+    std::array<Group, (maxSections + maxKernelSections - 1) / maxKernelSections> groups;
+    int numGroups = 0;
+
+    //the first pair's lanes, and every other pair's, which both run the first design
+    std::array<LanePairs, 2> lanePairs;
+
+    std::vector<ChannelState> channels;
+};
@@ -0,0 +1,309 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.cpp
+    Linear-phase FIR version of the EQ curve, designed off the audio thread.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEQ.h"
+
+LinearPhaseEQ::LinearPhaseEQ(ResponseFunction responseFunction) :
+juce::Thread("Thelassic linear phase design"),
+response(std::move(responseFunction))
+{
+}
+
+LinearPhaseEQ::~LinearPhaseEQ()
+{
+    cancelPendingUpdate();
+    stopThread(2000);
+}
+
+int LinearPhaseEQ::getFIRLengthForSampleRate(double sampleRate)
+{
+    return juce::nextPowerOfTwo(juce::roundToInt(sampleRate * 0.085));
+}
+
+void LinearPhaseEQ::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    processSpec = spec;
+    firLength.store(getFIRLengthForSampleRate(spec.sampleRate));
+
+    if (active.load() || allocated.load())
+        allocate();
+}
+
+void LinearPhaseEQ::setActive(bool shouldBeActive)
+{
+    if (active.exchange(shouldBeActive) == shouldBeActive)
+        return;
+
+    if (shouldBeActive && ! allocated.load())
+        triggerAsyncUpdate();
+}
+
+void LinearPhaseEQ::requestRedesign()
+{
+    redesignRequested.store(true);
+    notify();
+}
+
+void LinearPhaseEQ::handleAsyncUpdate()
+{
+    //prepare() may have got there first
+    if (active.load() && ! allocated.load() && processSpec.sampleRate > 0.0)
+        allocate();
+}
+
+void LinearPhaseEQ::allocate()
+{
+    const auto& spec = processSpec;
+
+    {
+        const juce::ScopedLock sl(designLock);
+
+        sampleRate = spec.sampleRate;
+
+        const auto length = getFIRLengthForSampleRate(sampleRate);
+        const auto order = juce::roundToInt(std::log2(length));
+
+        if (fft == nullptr || fft->getSize() != length)
+            fft = std::make_unique<juce::dsp::FFT>(order);
+
+        frequencies.resize(size_t(length / 2 + 1));
+        magnitudes.resize(frequencies.size());
+        spectrum.assign(size_t(length * 2), 0.f);
+
+        for (size_t k = 0; k < frequencies.size(); ++k)
+            frequencies[k] = double(k) * sampleRate / double(length);
+
+        //one sample longer than the impulse so the window is symmetric about its centre tap
+        window.resize(size_t(length + 1));
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(),
+                                                                 juce::dsp::WindowingFunction<float>::blackman,
+                                                                 false);
+
+        //backends disagree on whether the inverse is scaled, so measure it with a flat spectrum
+        for (int k = 0; k <= length / 2; ++k)
+            spectrum[size_t(k * 2)] = 1.f;
+
+        fft->performRealOnlyInverseTransform(spectrum.data());
+        inverseScale = 1.f / spectrum[0];
+
+        firLength.store(length);
+
+        if (! loadingQueue.has_value())
+            loadingQueue.emplace();
+
+        //the design thread loads every convolution, so they only come and go under the lock
+        pairs.resize((spec.numChannels + 1) / 2);
+
+        for (size_t index = 0; index < pairs.size(); ++index)
+        {
+            if (pairs[index] == nullptr)
+            {
+                pairs[index] = std::make_unique<Pair>();
+                pairs[index]->convolution = std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::NonUniform {256}, *loadingQueue->get());
+            }
+
+            auto& pair = *pairs[index];
+            auto pairSpec = spec;
+            pairSpec.numChannels = juce::jmin((juce::uint32)2, spec.numChannels - (juce::uint32)index * 2);
+            pair.convolution->prepare(pairSpec);
+
+            //an impulse kept from before at the same rate already has the right latency.
+            //otherwise wait out juce's 50 ms crossfade from the old one once the new one lands
+            pair.live.store(pair.convolution->getCurrentIRSize() == length);
+            pair.settleSamplesRemaining = juce::roundToInt(sampleRate * 0.1);
+        }
+
+        //every pair's is the same, they're all set up alike
+        convolutionLatency.store(pairs.empty() ? 0 : pairs.front()->convolution->getLatency());
+    }
+
+    doubleScratch.setSize((int)spec.numChannels, (int)spec.maximumBlockSize);
+    designAndLoad();
+
+    allocated.store(true, std::memory_order_release);
+
+    if (! isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+void LinearPhaseEQ::reset()
+{
+    if (! allocated.load(std::memory_order_acquire))
+        return;
+
+    for (auto& pair : pairs)
+        pair->convolution->reset();
+}
+
+void LinearPhaseEQ::process(const juce::dsp::AudioBlock<float>& block)
+{
+    processChannels(block, 0, block.getNumChannels());
+}
+
+void LinearPhaseEQ::process(const juce::dsp::AudioBlock<double>& block)
+{
+    processChannels(block, 0, block.getNumChannels());
+}
+
+void LinearPhaseEQ::processChannels(const juce::dsp::AudioBlock<float>& block, size_t firstChannel, size_t numChannels)
+{
+    jassert(firstChannel % 2 == 0);
+    
+    //still being allocated, and the host has been told about the latency already
+    if (! allocated.load(std::memory_order_acquire))
+    {
+        block.getSubsetChannelBlock(firstChannel, juce::jmin(numChannels, block.getNumChannels() - firstChannel)).clear();
+        return;
+    }
+    
+    const auto lastChannel = juce::jmin(firstChannel + numChannels, block.getNumChannels(), pairs.size() * 2);
+    
+    for (auto channel = firstChannel; channel < lastChannel; channel += 2)
+    {
+        auto pairBlock = block.getSubsetChannelBlock(channel, juce::jmin((size_t)2, lastChannel - channel));
+        auto& pair = *pairs[channel / 2];
+        
+        //the new impulse is only picked up by process(), so keep calling it while silent
+        pair.convolution->process(juce::dsp::ProcessContextReplacing<float>(pairBlock));
+        
+        if (pair.live.load(std::memory_order_relaxed))
+            continue;
+        
+        if (pair.convolution->getCurrentIRSize() == firLength.load(std::memory_order_relaxed))
+        {
+            pair.settleSamplesRemaining -= (int)pairBlock.getNumSamples();
+            
+            if (pair.settleSamplesRemaining <= 0)
+                pair.live.store(true);
+        }
+        
+        //the old or empty impulse doesn't have the latency the host was told about
+        pairBlock.clear();
+    }
+}
+
+void LinearPhaseEQ::processChannels(const juce::dsp::AudioBlock<double>& block, size_t firstChannel, size_t numChannels)
+{
+    if (! allocated.load(std::memory_order_acquire))
+    {
+        block.getSubsetChannelBlock(firstChannel, juce::jmin(numChannels, block.getNumChannels() - firstChannel)).clear();
+        return;
+    }
+    
+    const auto lastChannel = juce::jmin(firstChannel + numChannels, block.getNumChannels(), (size_t)doubleScratch.getNumChannels());
+    const auto chunkSize = (size_t)doubleScratch.getNumSamples();
+    
+    if (firstChannel >= lastChannel || chunkSize == 0)
+        return;
+    
+    //hosts may send more than the block size they promised, so go in chunks of what we have
+    for (size_t start = 0; start < block.getNumSamples(); start += chunkSize)
+    {
+        const auto numSamples = juce::jmin(chunkSize, block.getNumSamples() - start);
+        auto scratch = juce::dsp::AudioBlock<float>(doubleScratch).getSubBlock(0, numSamples);
+        
+        for (auto channel = firstChannel; channel < lastChannel; ++channel)
+        {
+            auto* source = block.getChannelPointer(channel) + start;
+            std::transform(source, source + numSamples, scratch.getChannelPointer(channel), [](double x) {return (float)x;});
+        }
+        
+        processChannels(scratch, firstChannel, lastChannel - firstChannel);
+        
+        for (auto channel = firstChannel; channel < lastChannel; ++channel)
+        {
+            auto* source = scratch.getChannelPointer(channel);
+            std::transform(source, source + numSamples, block.getChannelPointer(channel) + start, [](float x) {return (double)x;});
+        }
+    }
+}
+
+int LinearPhaseEQ::getLatencySamples() const
+{
+    return firLength.load() / 2 + getConvolutionLatency();
+}
+
+int LinearPhaseEQ::getTailSamples() const
+{
+    return firLength.load() + getConvolutionLatency();
+}
+
+bool LinearPhaseEQ::isImpulseLive() const
+{
+    if (! allocated.load(std::memory_order_acquire))
+        return false;
+    
+    return std::all_of(pairs.begin(), pairs.end(), [](const auto& pair) {return pair->live.load();});
+}
+
+int LinearPhaseEQ::getConvolutionLatency() const
+{
+    //the non-uniform head has none, so before allocate() there's nothing to add either
+    return convolutionLatency.load();
+}
+
+void LinearPhaseEQ::run()
+{
+    while (! threadShouldExit())
+    {
+        if (redesignRequested.exchange(false))
+            designAndLoad();
+        else
+            wait(-1);
+    }
+}
+
+void LinearPhaseEQ::designAndLoad()
+{
+    const juce::ScopedLock sl(designLock);
+
+    const auto length = firLength.load();
+    if (length == 0 || fft == nullptr)
+        return;
+
+    const auto numChannels = separateChannels.load() ? 2 : 1;
+    juce::AudioBuffer<float> impulse(numChannels, length);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        response(frequencies, magnitudes, sampleRate, channel);
+
+        //zero phase spectrum: the wanted magnitudes with no imaginary part
+        std::fill(spectrum.begin(), spectrum.end(), 0.f);
+        for (size_t k = 0; k < magnitudes.size(); ++k)
+            spectrum[k * 2] = (float)magnitudes[k];
+
+        fft->performRealOnlyInverseTransform(spectrum.data());
+
+        //rotate the zero phase impulse so it's centred on length / 2, then window it
+        auto* taps = impulse.getWritePointer(channel);
+
+        for (int n = 0; n < length; ++n)
+        {
+            taps[n] = spectrum[size_t((n + length / 2) % length)] * inverseScale * window[size_t(n)];
+        }
+    }
+
+    for (size_t index = 0; index < pairs.size(); ++index)
+    {
+        //past the first pair both channels run channel 0's impulse
+        const auto isStereo = index == 0 && numChannels == 2;
+        juce::AudioBuffer<float> pairImpulse(isStereo ? 2 : 1, length);
+
+        for (int channel = 0; channel < pairImpulse.getNumChannels(); ++channel)
+            pairImpulse.copyFrom(channel, 0, impulse, channel, 0, length);
+
+        pairs[index]->convolution->loadImpulseResponse(std::move(pairImpulse),
+                                                         sampleRate,
+                                                         isStereo ? juce::dsp::Convolution::Stereo::yes
+                                                                  : juce::dsp::Convolution::Stereo::no,
+                                                         juce::dsp::Convolution::Trim::no,
+                                                         juce::dsp::Convolution::Normalise::no);
+    }
+}
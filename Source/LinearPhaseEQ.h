@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.h
+    Linear-phase FIR version of the EQ curve, designed off the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <optional>
+
+/*
+ turns any magnitude response into a symmetric FIR and runs it through juce's
+ non-uniformly partitioned convolution, so the head costs no extra latency.
+ designs happen on a background thread whenever requestRedesign() is called, and the
+ convolution crossfades from the old impulse to the new one by itself.
+ latency is always exactly half the FIR length plus the convolution's own latency.
+ juce's convolution only does mono and stereo, so each pair of channels gets one of its own.
+ it loads impulses asynchronously, so after prepare() a pair stays silent until an impulse of
+ the new length is live and the crossfade into it is done: the latency the host was told is
+ only true from then on.
+ nothing but the latency is worked out until the first setActive(true): most instances never
+ use linear phase, so they get no design thread, convolutions or tables. once allocated it stays
+ allocated, and every instance's convolutions share one loading thread.
+ */
+class LinearPhaseEQ : private juce::Thread,
+                      private juce::AsyncUpdater
+{
+public:
+    /*
+     fills 'magnitudes' with the linear gain wanted at each of 'frequencies' for 'channel'.
+     called on the design thread, so it must read parameters in a thread safe way.
+     */
+    using ResponseFunction = std::function<void(const std::vector<double>& frequencies,
+                                                std::vector<double>& magnitudes,
+                                                double sampleRate,
+                                                int channel)>;
+
+    explicit LinearPhaseEQ(ResponseFunction responseFunction);
+    ~LinearPhaseEQ() override;
+
+    /*
+     when active, allocates and designs the first impulse straight away, so it's ready before
+     playback starts. otherwise it only works out the latency, for the host to be told up front.
+     */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    /*
+     safe to call from the audio thread. the first time it's made active outside prepare(),
+     the allocating happens on the message thread and the output is silence until it's done.
+     */
+    void setActive(bool shouldBeActive);
+
+    void process(const juce::dsp::AudioBlock<float>& block);
+    
+    //the FIR itself runs in float, double blocks go through a scratch buffer sized by prepare()
+    void process(const juce::dsp::AudioBlock<double>& block);
+    
+    /*
+     just channels [firstChannel, firstChannel + numChannels) of 'block', 'firstChannel' being
+     the first of a pair. different channels can be processed on different threads at once.
+     */
+    void processChannels(const juce::dsp::AudioBlock<float>& block, size_t firstChannel, size_t numChannels);
+    void processChannels(const juce::dsp::AudioBlock<double>& block, size_t firstChannel, size_t numChannels);
+
+    //safe to call from the audio thread, it wakes the design thread
+    void requestRedesign();
+
+    /*
+     with separate channels the second channel gets its own impulse, designed from the
+     response for channel 1. otherwise, and past the second channel, channels use channel 0's. takes effect with the
+     next design, so call requestRedesign() after changing it.
+     */
+    void setSeparateChannels(bool shouldBeSeparate) {separateChannels.store(shouldBeSeparate);}
+
+    int getLatencySamples() const;
+    
+    //how long the output keeps going after the input stops: the whole impulse, plus latency
+    int getTailSamples() const;
+    int getFIRLength() const {return firLength.load();}
+    
+    //true once every pair runs an impulse matching getLatencySamples(), safe from any thread
+    bool isImpulseLive() const;
+
+    //~85 ms of impulse, rounded up to a power of two: 4096 taps at 44.1 and 48 kHz
+    static int getFIRLengthForSampleRate(double sampleRate);
+
+private:
+    void run() override;
+    void handleAsyncUpdate() override;
+    
+    //builds the convolutions and tables for 'processSpec', designs and starts the design thread
+    void allocate();
+    void designAndLoad();
+    int getConvolutionLatency() const;
+
+    ResponseFunction response;
+
+    juce::dsp::ProcessSpec processSpec {};
+    std::atomic<bool> active {false};
+    
+    //set once allocate() is done, the audio thread leaves the convolutions alone until then
+    std::atomic<bool> allocated {false};
+    
+    //made by the first allocate(), it has to outlive the convolutions
+    std::optional<juce::SharedResourcePointer<juce::dsp::ConvolutionMessageQueue>> loadingQueue;
+
+    struct Pair
+    {
+        std::unique_ptr<juce::dsp::Convolution> convolution;
+        
+        //only touched by whichever thread is processing the pair
+        int settleSamplesRemaining = 0;
+        std::atomic<bool> live {false};
+    };
+    
+    //one per pair of channels, only the first ever gets a stereo impulse
+    std::vector<std::unique_ptr<Pair>> pairs;
+    juce::AudioBuffer<float> doubleScratch;
+
+    //held by prepare() and the design thread, never by the audio thread
+    juce::CriticalSection designLock;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<double> frequencies, magnitudes;
+    std::vector<float> spectrum, window;
+    float inverseScale = 1.f;
+    double sampleRate = 0.0;
+
+    std::atomic<int> firLength {0}, convolutionLatency {0};
+    std::atomic<bool> redesignRequested {false};
+    std::atomic<bool> separateChannels {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseEQ)
+};
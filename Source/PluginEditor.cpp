@@ -124,6 +124,92 @@ void LookAndFeel::drawToggleButton(juce::Graphics &g,
         
         g.strokePath(analyzerButton->randomPath, PathStrokeType(1.f));
     }
+    else if (dynamic_cast<SpectrogramButton*>(&toggleButton) != nullptr)
+    {
+        auto color = ! toggleButton.getToggleState() ? Colours::dimgrey : Colour(ColorPalette::Accent);
+        
+        g.setColour(color);
+        
+        auto bounds = toggleButton.getLocalBounds();
+        g.drawRect(bounds);
+        
+//        stacked rows standing in for the waterfall history
+        auto insetRect = bounds.reduced(4);
+        for( auto y = insetRect.getY(); y < insetRect.getBottom(); y += 3 )
+        {
+            g.setOpacity(jmap(float(y), float(insetRect.getY()), float(insetRect.getBottom()), 1.f, 0.2f));
+            g.fillRect(insetRect.getX(), y, insetRect.getWidth(), 2);
+        }
+    }
+    else if (dynamic_cast<FilledSpectrumButton*>(&toggleButton) != nullptr)
+    {
+        auto color = ! toggleButton.getToggleState() ? Colours::dimgrey : Colour(ColorPalette::Accent);
+        
+        g.setColour(color);
+        
+        auto bounds = toggleButton.getLocalBounds();
+        g.drawRect(bounds);
+        
+//        a filled hump standing in for the spectrum
+        auto insetRect = bounds.reduced(4).toFloat();
+        g.setGradientFill(ColourGradient(color, insetRect.getTopLeft(),
+                                         color.withAlpha(0.f), insetRect.getBottomLeft(),
+                                         false));
+        g.fillEllipse(insetRect.withTop(insetRect.getCentreY()).withHeight(insetRect.getHeight()));
+    }
+    else if (dynamic_cast<LinearPhaseButton*>(&toggleButton) != nullptr)
+    {
+        auto color = ! toggleButton.getToggleState() ? Colours::dimgrey : Colour(ColorPalette::Accent);
+        
+        g.setColour(color);
+        
+        auto bounds = toggleButton.getLocalBounds();
+        g.drawRect(bounds);
+        
+//        a symmetric impulse, the signature of a linear-phase filter
+        auto insetRect = bounds.reduced(4).toFloat();
+        auto centreX = insetRect.getCentreX();
+        auto baseline = insetRect.getBottom();
+        
+        for (int i = -3; i <= 3; ++i)
+        {
+            auto height = insetRect.getHeight() / float(1 + 2 * std::abs(i));
+            auto x = centreX + float(i) * insetRect.getWidth() / 8.f;
+            g.drawLine(x, baseline, x, baseline - height, i == 0 ? 2.f : 1.f);
+        }
+    }
+    else if (dynamic_cast<LeanModeButton*>(&toggleButton) != nullptr)
+    {
+        auto color = ! toggleButton.getToggleState() ? Colours::dimgrey : Colour(ColorPalette::Accent);
+        
+        g.setColour(color);
+        
+        auto bounds = toggleButton.getLocalBounds();
+        g.drawRect(bounds);
+        g.setFont(12.f);
+        g.drawFittedText("lean", bounds, Justification::centred, 1);
+    }
+    else if (dynamic_cast<ParameterSetButton*>(&toggleButton) != nullptr)
+    {
+        //always lit, it only says which set the knobs are showing
+        g.setColour(Colour(ColorPalette::Accent));
+        
+        auto bounds = toggleButton.getLocalBounds();
+        g.drawRect(bounds);
+        g.setFont(12.f);
+        g.drawFittedText(toggleButton.getToggleState() ? "set 2" : "set 1", bounds, Justification::centred, 1);
+    }
+    else if (dynamic_cast<ChannelsUnlinkedButton*>(&toggleButton) != nullptr)
+    {
+        auto color = ! toggleButton.getToggleState() ? Colours::dimgrey : Colour(ColorPalette::Accent);
+        
+        g.setColour(color);
+        
+        auto bounds = toggleButton.getLocalBounds();
+        g.drawRect(bounds);
+        g.setFont(12.f);
+        g.drawFittedText("L/R", bounds, Justification::centred, 1);
+    }
 }
 
 //====================================================================================
@@ -233,9 +319,345 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 }
 
 //====================================================================================
-ResponseCurveComponent::ResponseCurveComponent(ThelassicAudioProcessor& p) : audioProcessor(p),
-leftPathProducer(audioProcessor.leftChannelFifo),
-rightPathProducer(audioProcessor.rightChannelFifo)
+void TraceRenderer::resize(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        image = juce::Image();
+        return;
+    }
+    
+    if (image.isValid() && image.getWidth() == width && image.getHeight() == height)
+        return;
+    
+    image = juce::Image(juce::Image::ARGB, width, height, true);
+    
+    dirtyTop.assign(width, height);
+    dirtyBottom.assign(width, 0);
+    
+    juce::ColourGradient gradient(juce::Colour(ColorPalette::Accent).withAlpha(0.6f), 0.f, 0.f,
+                                  juce::Colour(ColorPalette::Primary).withAlpha(0.f), 0.f, float(height),
+                                  false);
+    fillColours.resize(height);
+    for (int y = 0; y < height; ++y)
+    {
+        fillColours[y] = gradient.getColourAtPosition(double(y) / double(height)).getPixelARGB();
+    }
+}
+
+size_t TraceRenderer::getMemoryUsage() const
+{
+    size_t bytes = (dirtyTop.capacity() + dirtyBottom.capacity()) * sizeof(int)
+                 + fillColours.capacity() * sizeof(juce::PixelARGB);
+    
+    if (image.isValid())
+        bytes += size_t(image.getWidth() * image.getHeight()) * sizeof(juce::PixelARGB);
+    
+    return bytes;
+}
+
+void TraceRenderer::markDirty(int x, int top, int bottom)
+{
+    dirtyTop[x] = juce::jmin(dirtyTop[x], top);
+    dirtyBottom[x] = juce::jmax(dirtyBottom[x], bottom);
+}
+
+void TraceRenderer::beginFrame()
+{
+    if (! image.isValid())
+        return;
+    
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readWrite);
+    
+    for (int x = 0; x < bitmap.width; ++x)
+    {
+        for (int y = dirtyTop[x]; y < dirtyBottom[x]; ++y)
+            reinterpret_cast<juce::PixelARGB*>(bitmap.getPixelPointer(x, y))->setARGB(0, 0, 0, 0);
+        
+        dirtyTop[x] = bitmap.height;
+        dirtyBottom[x] = 0;
+    }
+}
+
+void TraceRenderer::strokeTrace(const std::vector<float>& ys, juce::Colour colour, float thickness, float yOffset)
+{
+    if (! image.isValid() || ys.empty())
+        return;
+    
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readWrite);
+    
+    const auto pixel = colour.getPixelARGB();
+    const auto numColumns = juce::jmin(bitmap.width, (int)ys.size());
+    const auto halfThickness = thickness * 0.5f;
+    
+    for (int x = 0; x < numColumns; ++x)
+    {
+        //the span covers the line segments from the midpoints either side of this column
+        auto y = ys[x] + yOffset;
+        auto yLeft = x > 0 ? 0.5f * (ys[x - 1] + ys[x]) + yOffset : y;
+        auto yRight = x < numColumns - 1 ? 0.5f * (ys[x] + ys[x + 1]) + yOffset : y;
+        
+        auto spanTop = juce::jmin(y, yLeft, yRight) - halfThickness;
+        auto spanBottom = juce::jmax(y, yLeft, yRight) + halfThickness;
+        
+        auto firstRow = juce::jmax(0, (int)std::floor(spanTop));
+        auto lastRow = juce::jmin(bitmap.height, (int)std::ceil(spanBottom));
+        
+        if (firstRow >= lastRow)
+            continue;
+        
+        for (int row = firstRow; row < lastRow; ++row)
+        {
+            auto coverage = juce::jmin(float(row + 1), spanBottom) - juce::jmax(float(row), spanTop);
+            auto* dest = reinterpret_cast<juce::PixelARGB*>(bitmap.getPixelPointer(x, row));
+            
+            if (coverage >= 1.f)
+                dest->blend(pixel);
+            else
+                dest->blend(pixel, (juce::uint32)juce::roundToInt(coverage * 255.f));
+        }
+        
+        markDirty(x, firstRow, lastRow);
+    }
+}
+
+void TraceRenderer::fillTrace(const std::vector<float>& ys, float yOffset)
+{
+    if (! image.isValid() || ys.empty())
+        return;
+    
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readWrite);
+    
+    const auto numColumns = juce::jmin(bitmap.width, (int)ys.size());
+    
+    for (int x = 0; x < numColumns; ++x)
+    {
+        auto spanTop = ys[x] + yOffset;
+        auto firstRow = juce::jmax(0, (int)std::floor(spanTop));
+        
+        if (firstRow >= bitmap.height)
+            continue;
+        
+        auto* dest = reinterpret_cast<juce::PixelARGB*>(bitmap.getPixelPointer(x, firstRow));
+        auto coverage = juce::jlimit(0.f, 1.f, float(firstRow + 1) - spanTop);
+        dest->blend(fillColours[firstRow], (juce::uint32)juce::roundToInt(coverage * 255.f));
+        
+        for (int row = firstRow + 1; row < bitmap.height; ++row)
+        {
+            reinterpret_cast<juce::PixelARGB*>(bitmap.getPixelPointer(x, row))->blend(fillColours[row]);
+        }
+        
+        markDirty(x, firstRow, bitmap.height);
+    }
+}
+
+//====================================================================================
+SpectrogramRenderer::SpectrogramRenderer()
+{
+    using namespace juce;
+    
+    ColourGradient gradient;
+    gradient.addColour(0.0, Colour(ColorPalette::Primary));
+    gradient.addColour(0.4, Colour(ColorPalette::Accent));
+    gradient.addColour(0.8, Colour(ColorPalette::Pop));
+    gradient.addColour(1.0, Colour(ColorPalette::Tertiary));
+    
+    for (int i = 0; i < lutSize; ++i)
+    {
+        colourLUT[i] = gradient.getColourAtPosition(double(i) / double(lutSize - 1)).getPixelARGB();
+    }
+}
+
+void SpectrogramRenderer::resize(int width, int historyRows)
+{
+    if (width <= 0 || historyRows <= 0)
+    {
+        image = juce::Image();
+        return;
+    }
+    
+    if (image.isValid() && image.getWidth() == width && image.getHeight() == historyRows)
+        return;
+    
+    image = juce::Image(juce::Image::ARGB, width, historyRows, false);
+    clear();
+}
+
+size_t SpectrogramRenderer::getMemoryUsage() const
+{
+    size_t bytes = columns.getMemoryUsage();
+    
+    if (image.isValid())
+        bytes += size_t(image.getWidth() * image.getHeight()) * sizeof(juce::PixelARGB);
+    
+    return bytes;
+}
+
+void SpectrogramRenderer::clear()
+{
+    if (image.isValid())
+        image.clear(image.getBounds(), juce::Colour(ColorPalette::Primary));
+    
+    newestRow = 0;
+}
+
+void SpectrogramRenderer::pushFrame(const std::vector<float>& renderData,
+                                    int fftSize,
+                                    float binWidth,
+                                    float negativeInfinity)
+{
+    if (! image.isValid())
+        return;
+    
+    const auto width = image.getWidth();
+    
+    if (! columns.matches(width, fftSize, binWidth))
+        columns.rebuild(width, fftSize, binWidth);
+    
+    //the ring runs upwards so the newest row is always drawn at the top
+    newestRow = (newestRow == 0 ? image.getHeight() : newestRow) - 1;
+    
+    juce::Image::BitmapData bitmap(image, 0, newestRow, width, 1, juce::Image::BitmapData::writeOnly);
+    auto* line = bitmap.getLinePointer(0);
+    
+    const auto scale = float(lutSize - 1) / -negativeInfinity;
+    
+    for (int x = 0; x < width; ++x)
+    {
+        auto v = columns.valueForColumn(renderData, x);
+        auto index = juce::jlimit(0, lutSize - 1, int((v - negativeInfinity) * scale));
+        *reinterpret_cast<juce::PixelARGB*>(line + x * bitmap.pixelStride) = colourLUT[index];
+    }
+}
+
+void SpectrogramRenderer::draw(juce::Graphics& g, juce::Rectangle<int> area) const
+{
+    if (! image.isValid())
+        return;
+    
+    const auto width = image.getWidth();
+    const auto olderRows = image.getHeight() - newestRow;
+    
+    //newest..end of the ring on top, wrapped oldest rows underneath
+    g.drawImage(image,
+                area.getX(), area.getY(), width, olderRows,
+                0, newestRow, width, olderRows);
+    
+    if (newestRow > 0)
+    {
+        g.drawImage(image,
+                    area.getX(), area.getY() + olderRows, width, newestRow,
+                    0, 0, width, newestRow);
+    }
+}
+
+//====================================================================================
+void DisplayScheduler::addClient(DisplayClient* client)
+{
+    clients.addIfNotAlreadyThere(client);
+}
+
+void DisplayScheduler::removeClient(DisplayClient* client)
+{
+    clients.removeFirstMatchingValue(client);
+    
+    if (nextClient >= clients.size())
+        nextClient = 0;
+}
+
+bool DisplayScheduler::isVisible(juce::Component& comp)
+{
+    //isShowing() covers hidden parents and minimised windows, the peer also knows about occlusion
+    if (! comp.isShowing())
+        return false;
+    
+    auto* peer = comp.getPeer();
+    return peer != nullptr && peer->isShowing();
+}
+
+void DisplayScheduler::vblank()
+{
+    using namespace juce;
+    
+    //every open editor forwards its vblank here, only the first one in each frame does any work
+    const auto frameStart = Time::getMillisecondCounterHiRes();
+    if (frameStart - lastFrameMs < frameIntervalMs * 0.9)
+        return;
+    
+    lastFrameMs = frameStart;
+    
+    const auto numClients = clients.size();
+    
+    //the walk starts where the last frame's left off, and the next one after the last serviced
+    const auto start = nextClient;
+    auto next = start;
+    
+    for (int i = 0; i < numClients; ++i)
+    {
+        if (Time::getMillisecondCounterHiRes() - frameStart > frameBudgetMs)
+            break;
+        
+        auto index = (start + i) % numClients;
+        auto* client = clients.getUnchecked(index);
+        
+        if (! isVisible(client->getDisplayComponent()))
+            continue;
+        
+        client->refreshDisplay();
+        next = (index + 1) % numClients;
+    }
+    
+    nextClient = next;
+}
+
+//====================================================================================
+const AnalyzerQuality& AnalyzerQualityGovernor::getQuality() const
+{
+    static const AnalyzerQuality ladder[numLevels]
+    {
+        {1, FFTOrder::order2048, 1, 1, "full"},
+        {1, FFTOrder::order2048, 2, 2, "reduced overlap"},
+        {2, FFTOrder::order2048, 2, 2, "30 fps"},
+        {2, FFTOrder::order1024, 4, 4, "low resolution"},
+        {4, FFTOrder::order1024, 8, 4, "minimal"}
+    };
+    
+    return ladder[level];
+}
+
+bool AnalyzerQualityGovernor::endFrame()
+{
+    //cost per display frame, so skipped frames at the lower levels count in our favour
+    const auto frameCost = (analysisMs + paintMs) / getQuality().frameDivisor;
+    analysisMs = 0.0;
+    paintMs = 0.0;
+    
+    averageMs += 0.1 * (frameCost - averageMs);
+    
+    framesOverBudget = averageMs > budgetMs ? framesOverBudget + 1 : 0;
+    framesUnderBudget = averageMs < budgetMs * 0.4 ? framesUnderBudget + 1 : 0;
+    
+    //a few frames over budget is enough to back off, recovering needs a couple of seconds of headroom
+    if (framesOverBudget > 10 && level < numLevels - 1)
+    {
+        ++level;
+    }
+    else if (framesUnderBudget > 120 && level > 0)
+    {
+        --level;
+    }
+    else
+    {
+        return false;
+    }
+    
+    framesOverBudget = 0;
+    framesUnderBudget = 0;
+    return true;
+}
+
+//====================================================================================
+ResponseCurveComponent::ResponseCurveComponent(ThelassicAudioProcessor& p) : audioProcessor(p)
 {
     const auto& params = audioProcessor.getParameters();
     for (auto param : params)
@@ -245,11 +667,16 @@ rightPathProducer(audioProcessor.rightChannelFifo)
     
     updateChain();
     
-    startTimerHz(60);
+    displayScheduler->addClient(this);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
+    displayScheduler->removeClient(this);
+    
+    if (leftPathProducer != nullptr)
+        audioProcessor.analyzerClosed();
+    
     const auto& params = audioProcessor.getParameters();
     for (auto param : params)
     {
@@ -265,103 +692,90 @@ void ResponseCurveComponent::updateResponseCurve()
     auto responseArea = getAnalysisArea();
     auto w = responseArea.getWidth();
     
-    auto& locut = monoChain.get<ChainPositions::LoCut>();
-    auto& mid = monoChain.get<ChainPositions::Mid>();
-    auto& hicut = monoChain.get<ChainPositions::HiCut>();
-    
     auto sampleRate = audioProcessor.getSampleRate();
     
-    std::vector<double> mags;
-    mags.resize(w);
+    //rows are relative to the render area, which is where the trace image is drawn
+    const double outputMin = responseArea.getBottom() - getRenderArea().getY();
+    const double outputMax = responseArea.getY() - getRenderArea().getY();
+    auto map = [outputMin, outputMax](double input)
+    {
+        return jmap(input, -24.0, 24.0, outputMin, outputMax);
+    };
     
-    for (int i = 0; i < w; ++i)
+    auto fillCurve = [&](const CascadeDesign& curveDesign, std::vector<float>& curve)
     {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-        
-        if (!monoChain.isBypassed<ChainPositions::Mid>())
-            mag *= mid.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        curve.resize((size_t)w);
         
-        if (! monoChain.isBypassed<ChainPositions::LoCut>())
+        for (int i = 0; i < w; ++i)
         {
-            if (!locut.isBypassed<0>())
-                mag *= locut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!locut.isBypassed<1>())
-                mag *= locut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!locut.isBypassed<2>())
-                mag *= locut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!locut.isBypassed<3>())
-                mag *= locut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        
-        if (! monoChain.isBypassed<ChainPositions::HiCut>())
-        {
-            if (!hicut.isBypassed<0>())
-                mag *= hicut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!hicut.isBypassed<1>())
-                mag *= hicut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!hicut.isBypassed<2>())
-                mag *= hicut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!hicut.isBypassed<3>())
-                mag *= hicut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+            auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
+            auto mag = curveDesign.getMagnitudeForFrequency(freq, sampleRate);
+            
+            curve[(size_t)i] = (float)map(Decibels::gainToDecibels(mag));
         }
-        
-        mags [i] = Decibels::gainToDecibels(mag);
-    }
-    
-    responseCurve.clear();
-    
-    const double outputMin = responseArea.getBottom();
-    const double outputMax = responseArea.getY();
-    auto map = [outputMin, outputMax](double input)
-    {
-        return jmap(input, -24.0, 24.0, outputMin, outputMax);
     };
     
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    fillCurve(design, responseCurve);
     
-    for (size_t i = 1; i < mags.size(); ++i)
-    {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
-    }
+    if (showsSecondCurve)
+        fillCurve(secondDesign, secondResponseCurve);
+    else
+        secondResponseCurve.clear();
 }
 
 void ResponseCurveComponent::paint (juce::Graphics& g)
 {
     using namespace juce;
+    
+    const auto paintStart = Time::getMillisecondCounterHiRes();
+    
+    if (leftPathProducer == nullptr && ! analyzerBuildPending)
+    {
+        //the first frame goes out without it, the analyzer follows straight after
+        analyzerBuildPending = true;
+        
+        MessageManager::callAsync([safePtr = Component::SafePointer<ResponseCurveComponent>(this)]
+        {
+            if (auto* comp = safePtr.getComponent())
+                comp->buildAnalyzer();
+        });
+    }
+    
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (Colour(ColorPalette::Primary));
     
     drawBackgroundGrid(g);
 
-//    FFT analysis path
-    if (shouldShowFFTAnalysis)
+    traceRenderer.beginFrame();
+    
+//    FFT analysis
+    if (shouldShowFFTAnalysis && shouldShowSpectrogram)
     {
-        auto leftChannelFFTPath = leftPathProducer.getPath();
-        leftChannelFFTPath.applyTransform(AffineTransform().translation(getFFTArea().getX(),
-                                                                        getFFTArea().getY()));
-        
-        g.setColour(Colour(ColorPalette::Pop));
-        g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
+        spectrogram.draw(g, getFFTArea());
+    }
+    else if (shouldShowFFTAnalysis && leftPathProducer != nullptr)
+    {
+        //the fft area shares its origin with the render area, so traces need no offset
+        const auto& leftChannelFFTTrace = leftPathProducer->getTrace();
+        const auto& rightChannelFFTTrace = rightPathProducer->getTrace();
         
-        auto rightChannelFFTPath = rightPathProducer.getPath();
-        rightChannelFFTPath.applyTransform(AffineTransform().translation(getFFTArea().getX(),
-                                                                         getFFTArea().getY()));
+        if (shouldFillSpectrum)
+        {
+            traceRenderer.fillTrace(leftChannelFFTTrace);
+            traceRenderer.fillTrace(rightChannelFFTTrace);
+        }
         
-        g.setColour(Colour(ColorPalette::Tertiary));
-        g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+        traceRenderer.strokeTrace(leftChannelFFTTrace, Colour(ColorPalette::Pop), 1.f);
+        traceRenderer.strokeTrace(rightChannelFFTTrace, Colour(ColorPalette::Tertiary), 1.f);
     }
     
-//    EQ response curve path
-    g.setColour(Colour(ColorPalette::Accent));
-    g.strokePath(responseCurve, PathStrokeType(2.f));
-    
-    Path border;
+//    EQ response curve, with the side's or right's under it when they differ
+    if (! secondResponseCurve.empty())
+        traceRenderer.strokeTrace(secondResponseCurve, Colour(ColorPalette::Pop), 2.f);
     
-    border.setUsingNonZeroWinding(false);
+    traceRenderer.strokeTrace(responseCurve, Colour(ColorPalette::Accent), 2.f);
     
-    border.addRoundedRectangle(getRenderArea(), 4);
-    border.addRectangle(getLocalBounds());
+    g.drawImageAt(traceRenderer.getImage(), getRenderArea().getX(), getRenderArea().getY());
     
     g.setColour(Colour(ColorPalette::Secondary));
     g.fillPath(border);
@@ -371,6 +785,134 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     g.setColour(Colour(ColorPalette::Tertiary));
     g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
     
+    drawQualityLabel(g);
+    
+    if (shouldShowDiagnostics)
+        drawDiagnosticsOverlay(g);
+    
+    const auto paintMs = Time::getMillisecondCounterHiRes() - paintStart;
+    qualityGovernor.addPaintTime(paintMs);
+    paintTiming.addSample(paintMs);
+}
+
+void ResponseCurveComponent::drawDiagnosticsOverlay(juce::Graphics &g)
+{
+    using namespace juce;
+    
+    const auto lines = getDiagnostics().toLines();
+    
+    const int fontHeight = 10;
+    g.setFont(Font(Font::getDefaultMonospacedFontName(), float(fontHeight), Font::plain));
+    
+    auto textWidth = 0;
+    for (const auto& line : lines)
+        textWidth = jmax(textWidth, g.getCurrentFont().getStringWidth(line));
+    
+    auto r = getFFTArea().reduced(4);
+    r = r.removeFromRight(textWidth + 8).removeFromTop(lines.size() * (fontHeight + 2) + 6);
+    
+    g.setColour(Colour(ColorPalette::Primary).withAlpha(0.85f));
+    g.fillRoundedRectangle(r.toFloat(), 3.f);
+    
+    g.setColour(Colour(ColorPalette::Tertiary));
+    r.reduce(4, 3);
+    
+    for (const auto& line : lines)
+    {
+        g.drawFittedText(line, r.removeFromTop(fontHeight + 2), juce::Justification::centredLeft, 1);
+    }
+}
+
+AnalyzerDiagnostics ResponseCurveComponent::getDiagnostics() const
+{
+    AnalyzerDiagnostics diagnostics;
+    
+    auto fillChannel = [](AnalyzerDiagnostics::ChannelStats& stats, const PathProducer& producer)
+    {
+        stats.audio = producer.getAudioFifoCounters();
+        stats.fft = producer.getFFTFifoCounters();
+        stats.trace = producer.getTraceFifoCounters();
+        stats.fftMs = producer.getFFTTiming().getAverageMs();
+        stats.traceMs = producer.getTraceTiming().getAverageMs();
+    };
+    
+    if (leftPathProducer != nullptr)
+    {
+        fillChannel(diagnostics.left, *leftPathProducer);
+        fillChannel(diagnostics.right, *rightPathProducer);
+    }
+    
+    const auto& tapTiming = audioProcessor.getAnalyzerTapTiming();
+    diagnostics.tapMs = tapTiming.getAverageMs();
+    diagnostics.tapPeakMs = tapTiming.getPeakMs();
+    
+    const auto& filterTiming = audioProcessor.getFilterTiming();
+    diagnostics.filterMs = filterTiming.getAverageMs();
+    diagnostics.filterPeakMs = filterTiming.getPeakMs();
+    diagnostics.numCrossfades = audioProcessor.getNumTopologyCrossfades();
+    
+    diagnostics.paintMs = paintTiming.getAverageMs();
+    diagnostics.paintPeakMs = paintTiming.getPeakMs();
+    
+    const auto& editorOpenTiming = audioProcessor.getEditorOpenTiming();
+    diagnostics.editorOpenMs = editorOpenTiming.getLastMs();
+    diagnostics.editorOpenAverageMs = editorOpenTiming.getAverageMs();
+    
+    diagnostics.qualityLevel = qualityGovernor.getLevel();
+    diagnostics.coefficientCache = coefficientCache->getStatistics();
+    
+    return diagnostics;
+}
+
+juce::StringArray AnalyzerDiagnostics::toLines() const
+{
+    using namespace juce;
+    
+    auto fifoLine = [](const char* name, const FifoCounters& l, const FifoCounters& r)
+    {
+        String str;
+        str << name
+            << " L " << (int)l.pushes << "/" << (int)l.pulls << " drop " << (int)l.drops
+            << "  R " << (int)r.pushes << "/" << (int)r.pulls << " drop " << (int)r.drops;
+        return str;
+    };
+    
+    auto ms = [](float v) {return String(v, 3) + " ms";};
+    
+    StringArray lines;
+    lines.add("fifo   pushed/pulled");
+    lines.add(fifoLine("audio ", left.audio, right.audio));
+    lines.add(fifoLine("fft   ", left.fft, right.fft));
+    lines.add(fifoLine("trace ", left.trace, right.trace));
+    lines.add("tap    " + ms(tapMs) + "  peak " + ms(tapPeakMs));
+    lines.add("eq     " + ms(filterMs) + "  peak " + ms(filterPeakMs) + "  fades " + String(numCrossfades));
+    lines.add("fft    " + ms(left.fftMs + right.fftMs));
+    lines.add("trace  " + ms(left.traceMs + right.traceMs));
+    lines.add("paint  " + ms(paintMs) + "  peak " + ms(paintPeakMs));
+    lines.add("open   " + ms(editorOpenMs) + "  avg " + ms(editorOpenAverageMs));
+    lines.add("quality level " + String(qualityLevel));
+    lines.add("coeffs " + String((int64)coefficientCache.hits) + " hit " + String((int64)coefficientCache.misses) + " miss ("
+              + String(roundToInt(coefficientCache.getHitRate() * 100.0)) + "%)");
+    
+    return lines;
+}
+
+void ResponseCurveComponent::drawQualityLabel(juce::Graphics &g)
+{
+    using namespace juce;
+    
+    if (! shouldShowFFTAnalysis)
+        return;
+    
+    const int fontHeight = 10;
+    g.setFont(fontHeight);
+    g.setColour(qualityGovernor.getLevel() == 0 ? Colours::dimgrey : Colour(ColorPalette::Pop));
+    
+    String str;
+    str << "analyzer: " << qualityGovernor.getQuality().name;
+    
+    auto r = getFFTArea().reduced(4).removeFromTop(fontHeight);
+    g.drawFittedText(str, r, juce::Justification::centredLeft, 1);
 }
 
 std::vector<float> ResponseCurveComponent::getFrequencies()
@@ -519,8 +1061,83 @@ void ResponseCurveComponent::resized()
 {
     using namespace juce;
     
-    responseCurve.preallocateSpace(getWidth() * 3);
     updateResponseCurve();
+    
+    auto renderArea = getRenderArea();
+    traceRenderer.resize(renderArea.getWidth(), renderArea.getHeight());
+    
+    border.clear();
+    border.setUsingNonZeroWinding(false);
+    border.addRoundedRectangle(renderArea, 4);
+    border.addRectangle(getLocalBounds());
+    
+    updateSpectrogramSize();
+}
+
+void ResponseCurveComponent::updateSpectrogramSize()
+{
+    auto fftArea = getFFTArea();
+    
+    if (shouldShowSpectrogram)
+        spectrogram.resize(fftArea.getWidth(), fftArea.getHeight());
+    else
+        spectrogram.resize(0, 0);
+}
+
+size_t ResponseCurveComponent::getMemoryUsage() const
+{
+    size_t bytes = 0;
+    
+    if (leftPathProducer != nullptr)
+        bytes += leftPathProducer->getMemoryUsage() + rightPathProducer->getMemoryUsage();
+    
+    return bytes
+         + traceRenderer.getMemoryUsage()
+         + spectrogram.getMemoryUsage()
+         + (responseCurve.capacity() + secondResponseCurve.capacity()) * sizeof(float);
+}
+
+size_t PathProducer::getMemoryUsage() const
+{
+    return getAllocatedBytes(monoBuffer)
+         + leftChannelFFTDataGenerator.getMemoryUsage()
+         + getAllocatedBytes(latestFFTData)
+         + traceGenerator.getMemoryUsage()
+         + getAllocatedBytes(leftChannelFFTTrace);
+}
+
+void ResponseCurveComponent::toggleSpectrogram(bool enabled)
+{
+    shouldShowSpectrogram = enabled;
+    
+    updateSpectrogramSize();
+    spectrogram.clear();
+    
+    if (leftPathProducer != nullptr)
+    {
+        leftPathProducer->setSpectrogram(enabled ? &spectrogram : nullptr);
+        leftPathProducer->setTraceGenerationEnabled(! enabled);
+        rightPathProducer->setTraceGenerationEnabled(! enabled);
+    }
+}
+
+void ResponseCurveComponent::buildAnalyzer()
+{
+    analyzerBuildPending = false;
+    
+    if (leftPathProducer != nullptr)
+        return;
+    
+    //in lean mode this is what allocates the processor's analyzer tap
+    audioProcessor.analyzerOpened();
+    
+    leftPathProducer = std::make_unique<PathProducer>(audioProcessor.leftChannelFifo);
+    rightPathProducer = std::make_unique<PathProducer>(audioProcessor.rightChannelFifo);
+    
+    leftPathProducer->setQuality(qualityGovernor.getQuality());
+    rightPathProducer->setQuality(qualityGovernor.getQuality());
+    
+    toggleSpectrogram(shouldShowSpectrogram);
 }
 
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
@@ -528,56 +1145,107 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
     parametersChanged.set(true);
 }
 
+void PathProducer::setQuality(const AnalyzerQuality& quality)
+{
+    if (quality.fftOrder != leftChannelFFTDataGenerator.getOrder())
+    {
+        leftChannelFFTDataGenerator.changeOrder(quality.fftOrder);
+        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize(), false, true, false);
+        monoBuffer.clear();
+        
+        latestFFTData.resize(size_t(leftChannelFFTDataGenerator.getFFTSize() * 2));
+        hasNewFFTData = false;
+    }
+    
+    hopDivisor = quality.hopDivisor;
+    hopCounter = 0;
+    
+    traceGenerator.setResolution(quality.traceResolution);
+}
+
 void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
+    const auto binWidth = sampleRate / (double)fftSize;
     
-    while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
+    while (auto* incomingBuffer = leftChannelFifo->acquireAudioBuffer())
     {
-        if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
+        //blocks bigger than the fft only contribute their most recent samples
+        auto size = juce::jmin(incomingBuffer->getNumSamples(), monoBuffer.getNumSamples());
+        
+        juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
+                                          monoBuffer.getReadPointer(0, size),
+                                          monoBuffer.getNumSamples() - size);
+        
+        juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
+                                          incomingBuffer->getReadPointer(0, incomingBuffer->getNumSamples() - size),
+                                          size);
+        
+        leftChannelFifo->releaseAudioBuffer();
+        
+        if (++hopCounter < hopDivisor)
+            continue;
+        
+        hopCounter = 0;
+        
         {
-            auto size = tempIncomingBuffer.getNumSamples();
-            
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-                                              monoBuffer.getReadPointer(0, size),
-                                              monoBuffer.getNumSamples() - size);
-            
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                                              tempIncomingBuffer.getReadPointer(0, 0),
-                                              size);
-            
+            const ScopedStageTimer timer(fftTiming);
             leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+        }
+        
+        //every frame goes to the spectrogram, only the newest one is kept for the trace
+        while (auto* fftData = leftChannelFFTDataGenerator.acquireFFTData())
+        {
+            if (spectrogram != nullptr)
+                spectrogram->pushFrame(*fftData, fftSize, binWidth, -48.f);
             
+            std::swap(latestFFTData, *fftData);
+            hasNewFFTData = true;
+            
+            leftChannelFFTDataGenerator.releaseFFTData();
         }
     }
     
-    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-    const auto binWidth = sampleRate / (double)fftSize;
-    
-    while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks())
+    if (hasNewFFTData && traceGenerationEnabled)
     {
-        std::vector<float> fftData;
-        if (leftChannelFFTDataGenerator.getFFTData(fftData))
-        {
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
-        }
+        const ScopedStageTimer timer(traceTiming);
+        traceGenerator.generateTrace(latestFFTData, fftBounds, fftSize, binWidth, -48.f);
+        hasNewFFTData = false;
     }
     
-    while (pathProducer.getNumPathsAvailable() > 0)
+    while (auto* trace = traceGenerator.acquireTrace())
     {
-        pathProducer.getPath(leftChannelFFTPath);
+        std::swap(leftChannelFFTTrace, *trace);
+        traceGenerator.releaseTrace();
     }
 }
 
-void ResponseCurveComponent::timerCallback()
+void ResponseCurveComponent::refreshDisplay()
 {
-    if (shouldShowFFTAnalysis)
+    using namespace juce;
+    
+    if (++framesSinceService < qualityGovernor.getQuality().frameDivisor)
+        return;
+    
+    framesSinceService = 0;
+    
+    if (qualityGovernor.endFrame() && leftPathProducer != nullptr)
+    {
+        leftPathProducer->setQuality(qualityGovernor.getQuality());
+        rightPathProducer->setQuality(qualityGovernor.getQuality());
+    }
+    
+    if (shouldShowFFTAnalysis && leftPathProducer != nullptr)
     {
         auto fftBounds = getFFTArea().toFloat();
         auto sampleRate = audioProcessor.getSampleRate();
         
-        leftPathProducer.process(fftBounds, sampleRate);
-        rightPathProducer.process(fftBounds, sampleRate);
+        const auto analysisStart = Time::getMillisecondCounterHiRes();
+        
+        leftPathProducer->process(fftBounds, sampleRate);
+        rightPathProducer->process(fftBounds, sampleRate);
+        
+        qualityGovernor.addAnalysisTime(Time::getMillisecondCounterHiRes() - analysisStart);
     }
     
     if (parametersChanged.compareAndSetBool(false, true))
@@ -593,21 +1261,17 @@ void ResponseCurveComponent::timerCallback()
 
 void ResponseCurveComponent::updateChain()
 {
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
-    
-    monoChain.setBypassed<ChainPositions::LoCut>(chainSettings.loCutBypassed);
-    monoChain.setBypassed<ChainPositions::Mid>(chainSettings.midBypassed);
-    monoChain.setBypassed<ChainPositions::HiCut>(chainSettings.hiCutBypassed);
+    const auto chainSettings = chainParameters.load();
+    designCascade(chainSettings, audioProcessor.getSampleRate(), design, coefficientCache.get());
     
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Mid>().coefficients, peakCoefficients);
-    
-    auto loCutCoefficients = makeLoCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto hiCutCoefficients = makeHiCutFilter(chainSettings, audioProcessor.getSampleRate());
-    
-    updateCutFilter(monoChain.get<ChainPositions::LoCut>(), loCutCoefficients, chainSettings.loCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HiCut>(), hiCutCoefficients, chainSettings.hiCutSlope);
+    //a second set that matches the first would only draw over it
+    const auto separateChannels = audioProcessor.apvts.getRawParameterValue("Stereo Mode")->load() > 0.5f
+                                  || audioProcessor.apvts.getRawParameterValue("Channels Unlinked")->load() > 0.5f;
+    const auto secondChainSettings = separateChannels ? secondChainParameters.load() : chainSettings;
+    showsSecondCurve = secondChainSettings != chainSettings;
     
+    if (showsSecondCurve)
+        designCascade(secondChainSettings, audioProcessor.getSampleRate(), secondDesign, coefficientCache.get());
 }
 
 juce::Rectangle<int> ResponseCurveComponent::getRenderArea()
@@ -652,18 +1316,11 @@ ThelassicAudioProcessorEditor::ThelassicAudioProcessorEditor (ThelassicAudioProc
 
     responseCurveComponent(audioProcessor),
 
-    midFreqSliderAttachment(audioProcessor.apvts, "Mid Freq", midFreqSlider),
-    midGainSliderAttachment(audioProcessor.apvts, "Mid Gain", midGainSlider),
-    midQSliderAttachment(audioProcessor.apvts, "Mid Q", midQSlider),
-    loCutFreqSliderAttachment(audioProcessor.apvts, "Lo Cut Freq", loCutFreqSlider),
-    hiCutFreqSliderAttachment(audioProcessor.apvts, "Hi Cut Freq", hiCutFreqSlider),
-    loCutSlopeSliderAttachment(audioProcessor.apvts, "Lo Cut Slope", loCutSlopeSlider),
-    hiCutSlopeSliderAttachment(audioProcessor.apvts, "Hi Cut Slope", hiCutSlopeSlider),
-
-    loCutBypassButtonAttachmant(audioProcessor.apvts, "Lo Cut Bypassed", loCutBypassButton),
-    midBypassButtonAttachment(audioProcessor.apvts, "Mid Bypassed", midBypassButton),
-    hiCutBypassButtonAttachmant(audioProcessor.apvts, "Hi Cut Bypassed", hiCutBypassButton),
-    analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton)
+    analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton),
+    spectrogramEnabledButtonAttachment(audioProcessor.apvts, "Spectrogram Enabled", spectrogramEnabledButton),
+    filledSpectrumButtonAttachment(audioProcessor.apvts, "Analyzer Filled", filledSpectrumButton),
+    linearPhaseButtonAttachment(audioProcessor.apvts, "Linear Phase", linearPhaseButton),
+    channelsUnlinkedButtonAttachment(audioProcessor.apvts, "Channels Unlinked", channelsUnlinkedButton)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -694,11 +1351,37 @@ ThelassicAudioProcessorEditor::ThelassicAudioProcessorEditor (ThelassicAudioProc
         addAndMakeVisible(comp);
     }
     
-    loCutBypassButton.setLookAndFeel(&lnf);
-    midBypassButton.setLookAndFeel(&lnf);
-    hiCutBypassButton.setLookAndFeel(&lnf);
+    loCutBypassButton.setLookAndFeel(&lnf.get());
+    midBypassButton.setLookAndFeel(&lnf.get());
+    hiCutBypassButton.setLookAndFeel(&lnf.get());
+    
+    analyzerEnabledButton.setLookAndFeel(&lnf.get());
+    spectrogramEnabledButton.setLookAndFeel(&lnf.get());
+    filledSpectrumButton.setLookAndFeel(&lnf.get());
+    linearPhaseButton.setLookAndFeel(&lnf.get());
+    leanModeButton.setLookAndFeel(&lnf.get());
+    parameterSetButton.setLookAndFeel(&lnf.get());
+    channelsUnlinkedButton.setLookAndFeel(&lnf.get());
+    
+    leanModeButton.setToggleState(audioProcessor.isLeanMode(), juce::dontSendNotification);
+    
+    //the attachment selects by item index, so the items have to be there first
+    if (auto* stereoMode = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Stereo Mode")))
+        stereoModeComboBox.addItemList(stereoMode->choices, 1);
     
-    analyzerEnabledButton.setLookAndFeel(&lnf);
+    stereoModeComboBoxAttachment = std::make_unique<APVTS::ComboBoxAttachment>(audioProcessor.apvts, "Stereo Mode", stereoModeComboBox);
+    
+    //both sets' cut parameters have the same choices, so the items only go in once
+    auto addChoices = [this](juce::ComboBox& comboBox, const juce::String& parameterID)
+    {
+        if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter(parameterID)))
+            comboBox.addItemList(choice->choices, 1);
+    };
+    
+    addChoices(loCutResponseComboBox, getBandParameterID(0, "Response"));
+    addChoices(loCutSteepSlopeComboBox, getBandParameterID(0, "Steep Slope"));
+    addChoices(hiCutResponseComboBox, getBandParameterID(2, "Response"));
+    addChoices(hiCutSteepSlopeComboBox, getBandParameterID(2, "Steep Slope"));
     
     auto safePtr = juce::Component::SafePointer<ThelassicAudioProcessorEditor>(this);
         midBypassButton.onClick = [safePtr]()
@@ -722,6 +1405,8 @@ ThelassicAudioProcessorEditor::ThelassicAudioProcessorEditor (ThelassicAudioProc
                 
                 comp->loCutFreqSlider.setEnabled( !bypassed );
                 comp->loCutSlopeSlider.setEnabled( !bypassed );
+                comp->loCutResponseComboBox.setEnabled( !bypassed );
+                comp->loCutSteepSlopeComboBox.setEnabled( !bypassed );
             }
         };
         
@@ -733,6 +1418,8 @@ ThelassicAudioProcessorEditor::ThelassicAudioProcessorEditor (ThelassicAudioProc
                 
                 comp->hiCutFreqSlider.setEnabled( !bypassed );
                 comp->hiCutSlopeSlider.setEnabled( !bypassed );
+                comp->hiCutResponseComboBox.setEnabled( !bypassed );
+                comp->hiCutSteepSlopeComboBox.setEnabled( !bypassed );
             }
         };
 
@@ -745,6 +1432,41 @@ ThelassicAudioProcessorEditor::ThelassicAudioProcessorEditor (ThelassicAudioProc
             }
         };
     
+        spectrogramEnabledButton.onClick = [safePtr]()
+        {
+            if( auto* comp = safePtr.getComponent() )
+            {
+                auto enabled = comp->spectrogramEnabledButton.getToggleState();
+                comp->responseCurveComponent.toggleSpectrogram(enabled);
+            }
+        };
+    
+        filledSpectrumButton.onClick = [safePtr]()
+        {
+            if( auto* comp = safePtr.getComponent() )
+            {
+                auto enabled = comp->filledSpectrumButton.getToggleState();
+                comp->responseCurveComponent.toggleFilledSpectrum(enabled);
+            }
+        };
+    
+        leanModeButton.onClick = [safePtr]()
+        {
+            if( auto* comp = safePtr.getComponent() )
+                comp->audioProcessor.setLeanMode(comp->leanModeButton.getToggleState());
+        };
+    
+        parameterSetButton.onClick = [safePtr]()
+        {
+            if( auto* comp = safePtr.getComponent() )
+                comp->attachToParameterSet(comp->parameterSetButton.getToggleState() ? 1 : 0);
+        };
+    
+    attachToParameterSet(0);
+    
+    responseCurveComponent.toggleSpectrogram(spectrogramEnabledButton.getToggleState());
+    responseCurveComponent.toggleFilledSpectrum(filledSpectrumButton.getToggleState());
+    
     setSize (550, 550);
 }
 
@@ -755,6 +1477,66 @@ ThelassicAudioProcessorEditor::~ThelassicAudioProcessorEditor()
     hiCutBypassButton.setLookAndFeel(nullptr);
     
     analyzerEnabledButton.setLookAndFeel(nullptr);
+    spectrogramEnabledButton.setLookAndFeel(nullptr);
+    filledSpectrumButton.setLookAndFeel(nullptr);
+    linearPhaseButton.setLookAndFeel(nullptr);
+    leanModeButton.setLookAndFeel(nullptr);
+    parameterSetButton.setLookAndFeel(nullptr);
+    channelsUnlinkedButton.setLookAndFeel(nullptr);
+}
+
+void ThelassicAudioProcessorEditor::attachToParameterSet(int set)
+{
+    auto& apvts = audioProcessor.apvts;
+    
+    //an attachment has to let go of its knob before another one can take it
+    auto attachSlider = [&apvts, set](RotarySliderWithLabels& slider, std::unique_ptr<Attachment>& attachment,
+                                      int band, const char* parameter)
+    {
+        const auto id = getBandParameterID(band, parameter, set);
+        
+        attachment.reset();
+        slider.setParameter(*apvts.getParameter(id));
+        attachment = std::make_unique<Attachment>(apvts, id, slider);
+    };
+    
+    auto attachComboBox = [&apvts, set](juce::ComboBox& comboBox, std::unique_ptr<APVTS::ComboBoxAttachment>& attachment,
+                                        int band, const char* parameter)
+    {
+        attachment.reset();
+        attachment = std::make_unique<APVTS::ComboBoxAttachment>(apvts, getBandParameterID(band, parameter, set), comboBox);
+    };
+    
+    auto attachButton = [&apvts, set](juce::Button& button, std::unique_ptr<ButtonAttchment>& attachment, int band)
+    {
+        attachment.reset();
+        attachment = std::make_unique<ButtonAttchment>(apvts, getBandParameterID(band, "Bypassed", set), button);
+    };
+    
+    //the knobs are the original lo cut, mid and hi cut, bands 0, 1 and 2
+    attachSlider(loCutFreqSlider, loCutFreqSliderAttachment, 0, "Freq");
+    attachSlider(loCutSlopeSlider, loCutSlopeSliderAttachment, 0, "Slope");
+    attachSlider(midFreqSlider, midFreqSliderAttachment, 1, "Freq");
+    attachSlider(midGainSlider, midGainSliderAttachment, 1, "Gain");
+    attachSlider(midQSlider, midQSliderAttachment, 1, "Q");
+    attachSlider(hiCutFreqSlider, hiCutFreqSliderAttachment, 2, "Freq");
+    attachSlider(hiCutSlopeSlider, hiCutSlopeSliderAttachment, 2, "Slope");
+    
+    attachComboBox(loCutResponseComboBox, loCutResponseComboBoxAttachment, 0, "Response");
+    attachComboBox(loCutSteepSlopeComboBox, loCutSteepSlopeComboBoxAttachment, 0, "Steep Slope");
+    attachComboBox(hiCutResponseComboBox, hiCutResponseComboBoxAttachment, 2, "Response");
+    attachComboBox(hiCutSteepSlopeComboBox, hiCutSteepSlopeComboBoxAttachment, 2, "Steep Slope");
+    
+    attachButton(loCutBypassButton, loCutBypassButtonAttachmant, 0);
+    attachButton(midBypassButton, midBypassButtonAttachment, 1);
+    attachButton(hiCutBypassButton, hiCutBypassButtonAttachmant, 2);
+    
+    //the new set's bands may be bypassed where the old set's weren't, and the other way round
+    for (auto* button : {&loCutBypassButton, &midBypassButton, &hiCutBypassButton})
+    {
+        if (button->onClick != nullptr)
+            button->onClick();
+    }
 }
 
 //==============================================================================
@@ -766,6 +1548,20 @@ void ThelassicAudioProcessorEditor::paint (juce::Graphics& g)
 
 }
 
+void ThelassicAudioProcessorEditor::paintOverChildren (juce::Graphics&)
+{
+    using namespace juce;
+    
+    //children are done too by now, so this is the whole first frame
+    if (hasPaintedFirstFrame)
+        return;
+    
+    hasPaintedFirstFrame = true;
+    
+    const auto ms = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - constructionStartTicks) * 1000.0;
+    audioProcessor.getEditorOpenTiming().addSample(ms);
+}
+
 void ThelassicAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
@@ -775,11 +1571,24 @@ void ThelassicAudioProcessorEditor::resized()
 
     auto analyzerEnabledArea = bounds.removeFromTop(25);
     
-    analyzerEnabledArea.setWidth(100);
+    analyzerEnabledArea.setWidth(80);
     analyzerEnabledArea.setX(5);
     analyzerEnabledArea.removeFromTop(2);
     
     analyzerEnabledButton.setBounds(analyzerEnabledArea);
+    spectrogramEnabledButton.setBounds(analyzerEnabledArea.translated(analyzerEnabledArea.getWidth() + 5, 0));
+    filledSpectrumButton.setBounds(analyzerEnabledArea.translated((analyzerEnabledArea.getWidth() + 5) * 2, 0));
+    leanModeButton.setBounds(analyzerEnabledArea.translated((analyzerEnabledArea.getWidth() + 5) * 3, 0).withWidth(40));
+    
+    //the processing and stereo modes sit together at the far end
+    auto modeArea = analyzerEnabledArea.withX(0).withWidth(getWidth() - 5);
+    linearPhaseButton.setBounds(modeArea.removeFromRight(analyzerEnabledArea.getWidth()));
+    modeArea.removeFromRight(5);
+    stereoModeComboBox.setBounds(modeArea.removeFromRight(75));
+    modeArea.removeFromRight(5);
+    channelsUnlinkedButton.setBounds(modeArea.removeFromRight(35));
+    modeArea.removeFromRight(5);
+    parameterSetButton.setBounds(modeArea.removeFromRight(35));
     bounds.removeFromTop(5);
     
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * 0.33);
@@ -789,11 +1598,21 @@ void ThelassicAudioProcessorEditor::resized()
     auto loCutArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
     auto hiCutArea = bounds.removeFromRight(bounds.getWidth() * 0.5);
     
+    //the response and steep slope boxes share a row under each cut's slope knob
+    auto layOutCutBoxes = [](juce::Rectangle<int>& area, juce::ComboBox& response, juce::ComboBox& steepSlope)
+    {
+        auto row = area.removeFromBottom(22).reduced(5, 1);
+        response.setBounds(row.removeFromLeft(row.getWidth() / 2).withTrimmedRight(2));
+        steepSlope.setBounds(row.withTrimmedLeft(2));
+    };
+    
     loCutBypassButton.setBounds(loCutArea.removeFromTop(25));
+    layOutCutBoxes(loCutArea, loCutResponseComboBox, loCutSteepSlopeComboBox);
     loCutFreqSlider.setBounds(loCutArea.removeFromTop(loCutArea.getHeight() * 0.5));
     loCutSlopeSlider.setBounds(loCutArea);
     
     hiCutBypassButton.setBounds(hiCutArea.removeFromTop(25));
+    layOutCutBoxes(hiCutArea, hiCutResponseComboBox, hiCutSteepSlopeComboBox);
     hiCutFreqSlider.setBounds(hiCutArea.removeFromTop(hiCutArea.getHeight() * 0.5));
     hiCutSlopeSlider.setBounds(hiCutArea);
     
@@ -815,12 +1634,23 @@ std::vector<juce::Component*> ThelassicAudioProcessorEditor::getComps()
         &hiCutFreqSlider,
         &loCutSlopeSlider,
         &hiCutSlopeSlider,
+        &loCutResponseComboBox,
+        &loCutSteepSlopeComboBox,
+        &hiCutResponseComboBox,
+        &hiCutSteepSlopeComboBox,
         
         &responseCurveComponent,
         
         &loCutBypassButton,
         &midBypassButton,
         &hiCutBypassButton,
-        &analyzerEnabledButton
+        &analyzerEnabledButton,
+        &spectrogramEnabledButton,
+        &filledSpectrumButton,
+        &linearPhaseButton,
+        &leanModeButton,
+        &stereoModeComboBox,
+        &channelsUnlinkedButton,
+        &parameterSetButton
     };
 }
@@ -11,32 +11,35 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
-enum FFTOrder
-{
-    order2048 = 11,
-    order4096 = 12,
-    order8192 = 13
-};
-
 template<typename BlockType>
 struct FFTDataGenerator
 {
     /**
-     produces the FFT data from an audio buffer.
+     produces the FFT data from an audio buffer, straight into the next fifo slot.
+     does nothing if the consumer hasn't released a slot yet.
      */
     void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
     {
+        auto* slot = fftDataFifo.acquireWrite();
+        if( slot == nullptr )
+            return;
+        
         const auto fftSize = getFFTSize();
         
-        fftData.assign(fftData.size(), 0);
+        //consumers may have swapped in a buffer sized for another order
+        auto& fftData = *slot;
+        if( fftData.size() != size_t(fftSize * 2) )
+            fftData.resize(fftSize * 2);
+        
+        std::fill(fftData.begin(), fftData.end(), 0.f);
         auto* readIndex = audioData.getReadPointer(0);
         std::copy(readIndex, readIndex + fftSize, fftData.begin());
         
         // first apply a windowing function to our data
-        window->multiplyWithWindowingTable (fftData.data(), fftSize);       // [1]
+        plan->applyWindow (fftData.data());                                 // [1]
         
         // then render our FFT data..
-        forwardFFT->performFrequencyOnlyForwardTransform (fftData.data());  // [2]
+        plan->performFrequencyOnlyForwardTransform (fftData.data());        // [2]
         
         int numBins = (int)fftSize / 2;
         
@@ -62,107 +65,232 @@ struct FFTDataGenerator
             fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
         }
         
-        fftDataFifo.push(fftData);
+        fftDataFifo.commitWrite();
     }
     
     void changeOrder(FFTOrder newOrder)
     {
-        //when you change order, recreate the window, forwardFFT, fifo, fftData
-        //also reset the fifoIndex
-        //things that need recreating should be created on the heap via std::make_unique<>
+        //when you change order, fetch the shared fft + window plan and recreate the fifo
+        //the plan is shared by every analyzer in the process, so this only builds tables the first time
         
         order = newOrder;
         auto fftSize = getFFTSize();
         
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
-        
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
+        plan = planCache->getPlan(order, juce::dsp::WindowingFunction<float>::blackmanHarris);
 
-        fftDataFifo.prepare(fftData.size());
+        fftDataFifo.prepare(size_t(fftSize * 2));
     }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
+    FFTOrder getOrder() const { return order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
+    FifoCounters getFifoCounters() const { return fftDataFifo.getCounters(); }
+    size_t getMemoryUsage() const { return fftDataFifo.getMemoryUsage(); }
     //==============================================================================
-    bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    //read the oldest fft frame in place (or swap it out), then hand it back with releaseFFTData()
+    BlockType* acquireFFTData() { return fftDataFifo.acquireRead(); }
+    void releaseFFTData() { fftDataFifo.releaseRead(); }
 private:
     FFTOrder order;
-    BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    juce::SharedResourcePointer<FFTPlanCache> planCache;
+    FFTPlanCache::PlanPtr plan;
+    
+    //drained after every frame, so one ready frame is all it ever needs to hold
+    Fifo<BlockType, 2> fftDataFifo;
+};
+
+/*
+ maps pixel columns on the log frequency axis to fft bins.
+ shared by everything that turns fft data into one value per column.
+ */
+struct ColumnBinMap
+{
+    bool matches(int width, int fftSize, float binWidth) const
+    {
+        return width == mappedWidth && fftSize == mappedFFTSize && binWidth == mappedBinWidth;
+    }
+    
+    void rebuild(int width, int fftSize, float binWidth)
+    {
+        const auto numBins = fftSize / 2;
+        
+        binStart.resize(width + 1);
+        fraction.resize(width + 1);
+        
+        for (int x = 0; x <= width; ++x)
+        {
+            auto freq = juce::mapToLog10(float(x) / float(width), 20.f, 20000.f);
+            auto bin = juce::jlimit(0.f, float(numBins - 2), freq / binWidth);
+            binStart[x] = int(bin);
+            fraction[x] = bin - float(binStart[x]);
+        }
+        
+        mappedWidth = width;
+        mappedFFTSize = fftSize;
+        mappedBinWidth = binWidth;
+    }
     
-    Fifo<BlockType> fftDataFifo;
+    /*
+     the loudest bin when several bins land in the column (top end),
+     otherwise interpolated between the two nearest bins (bottom end).
+     */
+    float valueForColumn(const std::vector<float>& renderData, int x) const
+    {
+        const auto first = binStart[x];
+        const auto last = binStart[x + 1];
+        
+        if (last > first + 1)
+        {
+            auto v = renderData[first];
+            for (int bin = first + 1; bin < last; ++bin)
+                v = juce::jmax(v, renderData[bin]);
+            return v;
+        }
+        
+        return renderData[first] + fraction[x] * (renderData[first + 1] - renderData[first]);
+    }
+    
+    size_t getMemoryUsage() const {return binStart.capacity() * sizeof(int) + fraction.capacity() * sizeof(float);}
+    
+private:
+    std::vector<int> binStart;
+    std::vector<float> fraction;
+    int mappedWidth = 0, mappedFFTSize = 0;
+    float mappedBinWidth = 0.f;
 };
 
-template<typename PathType>
-struct AnalyzerPathGenerator
+template<typename TraceType>
+struct AnalyzerTraceGenerator
 {
     /*
-     converts 'renderData[]' into a juce::Path
+     converts 'renderData[]' into one y position per pixel column of 'fftBounds',
+     written straight into the next fifo slot
      */
-    void generatePath(const std::vector<float>& renderData,
-                      juce::Rectangle<float> fftBounds,
-                      int fftSize,
-                      float binWidth,
-                      float negativeInfinity)
+    void generateTrace(const std::vector<float>& renderData,
+                       juce::Rectangle<float> fftBounds,
+                       int fftSize,
+                       float binWidth,
+                       float negativeInfinity)
     {
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
-
-        int numBins = (int)fftSize / 2;
-
-        PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
-
-        auto map = [bottom, top, negativeInfinity](float v)
+        auto width = (int)fftBounds.getWidth();
+        
+        if (width <= 0)
+            return;
+        
+        auto* slot = traceFifo.acquireWrite();
+        if (slot == nullptr)
+            return;
+        
+        if (! columns.matches(width, fftSize, binWidth))
+            columns.rebuild(width, fftSize, binWidth);
+        
+        auto& trace = *slot;
+        trace.resize(width);
+        
+        auto columnY = [&](int x)
         {
-            return juce::jmap(v,
-                              negativeInfinity, 0.f,
-                              float(bottom+10),   top);
+            auto y = juce::jmap(columns.valueForColumn(renderData, x),
+                                negativeInfinity, 0.f,
+                                float(bottom+10), top);
+            
+            if (std::isnan(y) || std::isinf(y))
+                y = bottom;
+            
+            return y;
         };
-
-        auto y = map(renderData[0]);
-
-//        jassert( !std::isnan(y) && !std::isinf(y) );
-        if( std::isnan(y) || std::isinf(y) )
-            y = bottom;
         
-        p.startNewSubPath(0, y);
-
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
-
-        for( int binNum = 1; binNum < numBins; binNum += pathResolution )
+        //evaluate every 'resolution' columns and interpolate the ones in between
+        int previousX = 0;
+        trace[0] = columnY(0);
+        
+        for (int x = resolution; previousX < width - 1; x += resolution)
         {
-            y = map(renderData[binNum]);
-
-//            jassert( !std::isnan(y) && !std::isinf(y) );
-
-            if( !std::isnan(y) && !std::isinf(y) )
-            {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
-            }
+            x = juce::jmin(x, width - 1);
+            trace[x] = columnY(x);
+            
+            for (int i = previousX + 1; i < x; ++i)
+                trace[i] = juce::jmap(float(i), float(previousX), float(x), trace[previousX], trace[x]);
+            
+            previousX = x;
         }
-
-        pathFifo.push(p);
+        
+        traceFifo.commitWrite();
     }
-
-    int getNumPathsAvailable() const
+    
+    void setResolution(int columnsPerPoint) {resolution = juce::jmax(1, columnsPerPoint);}
+    
+    int getNumTracesAvailable() const
     {
-        return pathFifo.getNumAvailableForReading();
+        return traceFifo.getNumAvailableForReading();
     }
+    
+    FifoCounters getFifoCounters() const {return traceFifo.getCounters();}
+    size_t getMemoryUsage() const {return traceFifo.getMemoryUsage() + columns.getMemoryUsage();}
+    
+    //read the oldest trace in place (or swap it out), then hand it back with releaseTrace()
+    TraceType* acquireTrace() {return traceFifo.acquireRead();}
+    void releaseTrace() {traceFifo.releaseRead();}
+private:
+    ColumnBinMap columns;
+    int resolution = 1;
+    Fifo<TraceType, 2> traceFifo;
+};
+
+/*
+ rasterises monotonic-x traces (one y per column) straight into an image as vertical spans,
+ anti-aliased along y. only the spans touched by the previous frame are cleared.
+ */
+struct TraceRenderer
+{
+    void resize(int width, int height);
+    
+    void beginFrame();
+    void strokeTrace(const std::vector<float>& ys, juce::Colour colour, float thickness, float yOffset = 0.f);
+    void fillTrace(const std::vector<float>& ys, float yOffset = 0.f);
+    
+    const juce::Image& getImage() const {return image;}
+    
+    size_t getMemoryUsage() const;
+    
+private:
+    juce::Image image;
+    std::vector<int> dirtyTop, dirtyBottom;
+    
+    //premultiplied fill colour per row for the filled spectrum
+    std::vector<juce::PixelARGB> fillColours;
+    
+    void markDirty(int x, int top, int bottom);
+};
+
+/*
+ scrolling waterfall fed with the same dB data as the path analyzer.
+ each frame writes one row of a ring-buffered image through a colour lookup table,
+ and drawing just splits the ring at the write position, so history is never redrawn.
+ */
+struct SpectrogramRenderer
+{
+    SpectrogramRenderer();
+
+    void resize(int width, int historyRows);
+    void pushFrame(const std::vector<float>& renderData,
+                   int fftSize,
+                   float binWidth,
+                   float negativeInfinity);
+    void draw(juce::Graphics& g, juce::Rectangle<int> area) const;
+    void clear();
+    
+    size_t getMemoryUsage() const;
 
-    bool getPath(PathType& path)
-    {
-        return pathFifo.pull(path);
-    }
 private:
-    Fifo<PathType> pathFifo;
+    static constexpr int lutSize = 256;
+    std::array<juce::PixelARGB, lutSize> colourLUT;
+
+    juce::Image image;
+    int newestRow = 0;
+
+    ColumnBinMap columns;
 };
 
 enum ColorPalette
@@ -197,7 +325,7 @@ struct RotarySliderWithLabels : juce::Slider
     param(&rap),
     suffix(unitSuffix)
     {
-        setLookAndFeel(&lnf);
+        setLookAndFeel(&lnf.get());
     }
     
     ~RotarySliderWithLabels()
@@ -218,12 +346,57 @@ struct RotarySliderWithLabels : juce::Slider
     int getTextHeight() const {return 14;}
     juce::String getDisplayString() const;
     
+    //for switching the slider to another parameter set, the caller reattaches it
+    void setParameter(juce::RangedAudioParameter& rap)
+    {
+        param = &rap;
+        repaint();
+    }
+    
 private:
-    LookAndFeel lnf;
+    //stateless, so one instance is shared by every slider and editor in the process
+    juce::SharedResourcePointer<LookAndFeel> lnf;
     juce::RangedAudioParameter* param;
     juce::String suffix;
 };
 
+/*
+ one step on the analyzer's quality ladder.
+ */
+struct AnalyzerQuality
+{
+    int frameDivisor;       //service every n-th display frame
+    FFTOrder fftOrder;
+    int hopDivisor;         //run the fft on every n-th incoming block, i.e. less overlap
+    int traceResolution;    //evaluate every n-th column and interpolate the rest
+    const char* name;
+};
+
+/*
+ watches how long analysis and painting take per display frame and walks the quality ladder:
+ down quickly when the frame cost stays over budget, back up slowly once there's headroom again.
+ */
+struct AnalyzerQualityGovernor
+{
+    static constexpr int numLevels = 5;
+    static constexpr double budgetMs = 2.0;
+    
+    void addAnalysisTime(double ms) {analysisMs += ms;}
+    void addPaintTime(double ms) {paintMs += ms;}
+    
+    //call once per serviced frame. returns true if the quality level changed.
+    bool endFrame();
+    
+    int getLevel() const {return level;}
+    const AnalyzerQuality& getQuality() const;
+    double getAverageFrameCostMs() const {return averageMs;}
+    
+private:
+    int level = 0;
+    double analysisMs = 0.0, paintMs = 0.0, averageMs = 0.0;
+    int framesOverBudget = 0, framesUnderBudget = 0;
+};
+
 struct PathProducer
 {
     PathProducer(SingleChannelSimpleFifo<ThelassicAudioProcessor::BlockType>& scsf) :
@@ -231,9 +404,26 @@ struct PathProducer
     {
         leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
         monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        latestFFTData.resize(size_t(leftChannelFFTDataGenerator.getFFTSize() * 2));
     }
     void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath() {return leftChannelFFTPath;}
+    const std::vector<float>& getTrace() const {return leftChannelFFTTrace;}
+    
+    //when a spectrogram is attached it is fed instead of generating traces
+    void setSpectrogram(SpectrogramRenderer* target) {spectrogram = target;}
+    void setTraceGenerationEnabled(bool enabled) {traceGenerationEnabled = enabled;}
+    
+    void setQuality(const AnalyzerQuality& quality);
+    
+    FifoCounters getAudioFifoCounters() const {return leftChannelFifo->getCounters();}
+    FifoCounters getFFTFifoCounters() const {return leftChannelFFTDataGenerator.getFifoCounters();}
+    FifoCounters getTraceFifoCounters() const {return traceGenerator.getFifoCounters();}
+    
+    const StageTiming& getFFTTiming() const {return fftTiming;}
+    const StageTiming& getTraceTiming() const {return traceTiming;}
+    
+    //heap bytes held by the buffers, frames and traces
+    size_t getMemoryUsage() const;
     
 private:
     SingleChannelSimpleFifo<ThelassicAudioProcessor::BlockType>* leftChannelFifo;
@@ -242,14 +432,90 @@ private:
     
     FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
     
-    AnalyzerPathGenerator<juce::Path> pathProducer;
+    //the newest fft frame, swapped out of the fifo so the trace is only built once per display frame
+    std::vector<float> latestFFTData;
+    bool hasNewFFTData = false;
+    
+    AnalyzerTraceGenerator<std::vector<float>> traceGenerator;
     
-    juce::Path leftChannelFFTPath;
+    std::vector<float> leftChannelFFTTrace;
+    
+    SpectrogramRenderer* spectrogram = nullptr;
+    bool traceGenerationEnabled = true;
+    
+    int hopDivisor = 1, hopCounter = 0;
+    
+    StageTiming fftTiming, traceTiming;
+};
+
+/*
+ everything needed to tell where the analyzer pipeline is losing time or data:
+ traffic through each fifo, per channel, and the average/peak cost of each stage.
+ */
+struct AnalyzerDiagnostics
+{
+    struct ChannelStats
+    {
+        FifoCounters audio, fft, trace;
+        float fftMs = 0.f, traceMs = 0.f;
+    };
+    
+    ChannelStats left, right;
+    
+    float tapMs = 0.f, tapPeakMs = 0.f;
+    float filterMs = 0.f, filterPeakMs = 0.f;
+    int numCrossfades = 0;
+    float paintMs = 0.f, paintPeakMs = 0.f;
+    float editorOpenMs = 0.f, editorOpenAverageMs = 0.f;
+    
+    int qualityLevel = 0;
+    
+    CoefficientCache::Statistics coefficientCache;
+    
+    juce::StringArray toLines() const;
+};
+
+/*
+ anything the DisplayScheduler drives once per display frame.
+ */
+struct DisplayClient
+{
+    virtual ~DisplayClient() = default;
+    
+    virtual juce::Component& getDisplayComponent() = 0;
+    
+    //pull analysis data and repaint
+    virtual void refreshDisplay() = 0;
+};
+
+/*
+ one scheduler per process, shared by every open editor through juce::SharedResourcePointer.
+ every client's vblank attachment pokes it, it services at most once per display frame,
+ skips clients that can't be seen and stops when the frame's time slice is spent.
+ clients are visited round robin, so whoever missed out this frame goes first next frame.
+ */
+class DisplayScheduler
+{
+public:
+    void addClient(DisplayClient* client);
+    void removeClient(DisplayClient* client);
+    
+    void vblank();
+    
+    static constexpr double frameIntervalMs = 1000.0 / 60.0;
+    static constexpr double frameBudgetMs = 4.0;
+    
+private:
+    juce::Array<DisplayClient*> clients;
+    int nextClient = 0;
+    double lastFrameMs = 0.0;
+    
+    static bool isVisible(juce::Component& comp);
 };
 
 struct ResponseCurveComponent: juce::Component,
 juce::AudioProcessorParameter::Listener,
-juce::Timer
+DisplayClient
 {
     ResponseCurveComponent(ThelassicAudioProcessor&);
     ~ResponseCurveComponent();
@@ -258,13 +524,40 @@ juce::Timer
 
     void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
     
-    void timerCallback() override;
+    juce::Component& getDisplayComponent() override {return *this;}
+    void refreshDisplay() override;
     
     void toggleAnalysisEnablement(bool enabled)
     {
         shouldShowFFTAnalysis = enabled;
     }
     
+    void toggleSpectrogram(bool enabled);
+    
+    void toggleFilledSpectrum(bool enabled)
+    {
+        shouldFillSpectrum = enabled;
+    }
+    
+    //double-clicking the analyzer toggles the overlay too
+    void toggleDiagnosticsOverlay(bool enabled)
+    {
+        shouldShowDiagnostics = enabled;
+        repaint();
+    }
+    
+    bool isDiagnosticsOverlayVisible() const {return shouldShowDiagnostics;}
+    
+    AnalyzerDiagnostics getDiagnostics() const;
+    
+    //heap bytes held by the analyzer and its images
+    size_t getMemoryUsage() const;
+    
+    void mouseDoubleClick(const juce::MouseEvent&) override
+    {
+        toggleDiagnosticsOverlay(! shouldShowDiagnostics);
+    }
+    
     void paint(juce::Graphics& g) override;
     
     void resized() override;
@@ -272,14 +565,28 @@ private:
     ThelassicAudioProcessor& audioProcessor;
     
     bool shouldShowFFTAnalysis = true;
+    bool shouldShowSpectrogram = false;
+    bool shouldFillSpectrum = false;
+    bool shouldShowDiagnostics = false;
     
     juce::Atomic<bool> parametersChanged {false};
     
-    MonoChain monoChain;
+    ChainParameters chainParameters {audioProcessor.apvts};
+    juce::SharedResourcePointer<CoefficientCache> coefficientCache;
+    CascadeDesign design;
+    
+    //in mid/side or left/right the second set's bands get a curve of their own
+    ChainParameters secondChainParameters {audioProcessor.apvts, 1};
+    CascadeDesign secondDesign;
+    bool showsSecondCurve = false;
     
     void updateResponseCurve();
     
-    juce::Path responseCurve;
+    //one y per analysis area column, relative to the render area
+    std::vector<float> responseCurve, secondResponseCurve;
+    
+    TraceRenderer traceRenderer;
+    juce::Path border;
     
     void updateChain();
     
@@ -296,8 +603,28 @@ private:
     
     juce::Rectangle<int> getFFTArea();
     
-    PathProducer leftPathProducer, rightPathProducer;
+    /*
+     the analyzer (fft plans, fifos, buffers) isn't needed to show the first frame,
+     so it's built just after the first paint rather than with the component.
+     */
+    std::unique_ptr<PathProducer> leftPathProducer, rightPathProducer;
+    bool analyzerBuildPending = false;
+    void buildAnalyzer();
+    
+    //only allocated while it's showing
+    SpectrogramRenderer spectrogram;
+    void updateSpectrogramSize();
+    
+    AnalyzerQualityGovernor qualityGovernor;
+    int framesSinceService = 0;
+    
+    void drawQualityLabel(juce::Graphics& g);
     
+    StageTiming paintTiming;
+    void drawDiagnosticsOverlay(juce::Graphics& g);
+    
+    juce::SharedResourcePointer<DisplayScheduler> displayScheduler;
+    juce::VBlankAttachment vblankAttachment {this, [this] { displayScheduler->vblank(); }};
 };
 
 //==============================================================================
@@ -325,6 +652,13 @@ struct AnalyzerButton : juce::ToggleButton
         
         juce::Path randomPath;
 };
+
+struct SpectrogramButton : juce::ToggleButton {};
+struct FilledSpectrumButton : juce::ToggleButton {};
+struct LinearPhaseButton : juce::ToggleButton {};
+struct LeanModeButton : juce::ToggleButton {};
+struct ParameterSetButton : juce::ToggleButton {};
+struct ChannelsUnlinkedButton : juce::ToggleButton {};
 /**
 */
 class ThelassicAudioProcessorEditor  : public juce::AudioProcessorEditor
@@ -336,8 +670,16 @@ public:
     //==============================================================================
     void paint (juce::Graphics&) override;
     void resized() override;
+    
+    void paintOverChildren (juce::Graphics&) override;
+    
+    size_t getMemoryUsage() const {return sizeof(*this) + responseCurveComponent.getMemoryUsage();}
 
 private:
+    //first so it's taken before any other member is built
+    const juce::int64 constructionStartTicks = juce::Time::getHighResolutionTicks();
+    bool hasPaintedFirstFrame = false;
+    
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     ThelassicAudioProcessor& audioProcessor;
@@ -355,13 +697,25 @@ private:
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
     
-    Attachment midFreqSliderAttachment,
-               midGainSliderAttachment,
-               midQSliderAttachment,
-               loCutFreqSliderAttachment,
-               hiCutFreqSliderAttachment,
-               loCutSlopeSliderAttachment,
-               hiCutSlopeSliderAttachment;
+    //rebuilt whenever the set button switches the knobs between parameter sets
+    std::unique_ptr<Attachment> midFreqSliderAttachment,
+                                midGainSliderAttachment,
+                                midQSliderAttachment,
+                                loCutFreqSliderAttachment,
+                                hiCutFreqSliderAttachment,
+                                loCutSlopeSliderAttachment,
+                                hiCutSlopeSliderAttachment;
+    
+    //a cut's response, and its slope past 48 db/oct, which overrides the slope knob when it's on
+    juce::ComboBox loCutResponseComboBox,
+                   loCutSteepSlopeComboBox,
+                   hiCutResponseComboBox,
+                   hiCutSteepSlopeComboBox;
+    
+    std::unique_ptr<APVTS::ComboBoxAttachment> loCutResponseComboBoxAttachment,
+                                               loCutSteepSlopeComboBoxAttachment,
+                                               hiCutResponseComboBoxAttachment,
+                                               hiCutSteepSlopeComboBoxAttachment;
     
     std::vector<juce::Component*> getComps();
 
@@ -370,15 +724,40 @@ private:
                 hiCutBypassButton;
     
     AnalyzerButton analyzerEnabledButton;
+    SpectrogramButton spectrogramEnabledButton;
+    FilledSpectrumButton filledSpectrumButton;
+    LinearPhaseButton linearPhaseButton;
+    
+    //lean mode is plugin state rather than a parameter, so it has no attachment
+    LeanModeButton leanModeButton;
+    
+    juce::ComboBox stereoModeComboBox;
+    std::unique_ptr<APVTS::ComboBoxAttachment> stereoModeComboBoxAttachment;
+    
+    //left/right isn't a stereo mode, it's a parameter of its own
+    ChannelsUnlinkedButton channelsUnlinkedButton;
+    
+    /*
+     which parameter set the knobs, cut boxes and band bypass buttons edit: off for the first, on for the
+     "Ch2 " one, the side in mid/side or the right channel in left/right. only the editor's view,
+     so it isn't a parameter either.
+     */
+    ParameterSetButton parameterSetButton;
+    void attachToParameterSet(int set);
     
     using ButtonAttchment = APVTS::ButtonAttachment;
     
-    ButtonAttchment loCutBypassButtonAttachmant,
-                    midBypassButtonAttachment,
-                    hiCutBypassButtonAttachmant,
-                    analyzerEnabledButtonAttachment;
+    std::unique_ptr<ButtonAttchment> loCutBypassButtonAttachmant,
+                                     midBypassButtonAttachment,
+                                     hiCutBypassButtonAttachmant;
+    
+    ButtonAttchment analyzerEnabledButtonAttachment,
+                    spectrogramEnabledButtonAttachment,
+                    filledSpectrumButtonAttachment,
+                    linearPhaseButtonAttachment,
+                    channelsUnlinkedButtonAttachment;
     
-    LookAndFeel lnf;
+    juce::SharedResourcePointer<LookAndFeel> lnf;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThelassicAudioProcessorEditor)
 };
@@ -22,10 +22,12 @@ ThelassicAudioProcessor::ThelassicAudioProcessor()
                        )
 #endif
 {
+    updateAnalyzerTap();
 }
 
 ThelassicAudioProcessor::~ThelassicAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -63,7 +65,7 @@ bool ThelassicAudioProcessor::isMidiEffect() const
 
 double ThelassicAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int ThelassicAudioProcessor::getNumPrograms()
@@ -99,23 +101,152 @@ void ThelassicAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    spec.numChannels = (juce::uint32)getTotalNumOutputChannels();
     spec.sampleRate = sampleRate;
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    floatCascade.prepare((int)spec.numChannels, samplesPerBlock, sampleRate);
+    doubleCascade.prepare((int)spec.numChannels, samplesPerBlock, sampleRate);
+    floatSvf.prepare((int)spec.numChannels);
+    doubleSvf.prepare((int)spec.numChannels);
+    svfActive = apvts.getRawParameterValue("Filter Topology")->load() > 0.5f;
     
+    designIsStale = true;
     updateFilters();
     
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    //only instances that use linear phase pay for its convolutions and design thread
+    linearPhaseActive = apvts.getRawParameterValue("Linear Phase")->load() > 0.5f;
+    linearPhaseWanted = linearPhaseActive;
+    linearPhaseEQ.setActive(linearPhaseActive);
     
+    modeSwitchGain = 1.0;
+    modeSwitchStep = 1.0 / juce::jmax(1.0, sampleRate * BypassCrossfade<float>::fadeSeconds);
+    linearPhaseEQ.prepare(spec);
+    
+    //playback starts where the parameter is, not fading towards it
+    const auto bypassed = apvts.getRawParameterValue("Bypass")->load() > 0.5f;
+    const auto maximumLatency = linearPhaseEQ.getLatencySamples();
+    
+    floatBypass.prepare((int)spec.numChannels, samplesPerBlock, maximumLatency, sampleRate);
+    doubleBypass.prepare((int)spec.numChannels, samplesPerBlock, maximumLatency, sampleRate);
+    floatBypass.setBypassed(bypassed);
+    doubleBypass.setBypassed(bypassed);
+    floatBypass.reset();
+    doubleBypass.reset();
+    
+    //only offline renders of wide buses get workers, realtime playback never waits on another thread
+    channelWorkers.prepare(isNonRealtime() ? ChannelWorkerPool::getNumWorkersFor((int)spec.numChannels) : 0);
+    
+    //the latency has to be right before playback starts, not one block in
+    updateLatency();
+    handleUpdateNowIfNeeded();
+    silentSamples = 0;
+    updateTailLength();
+    
+    tapSampleRate = sampleRate;
+    tapBlockSize = samplesPerBlock;
+    updateAnalyzerTap();
+}
+
+//==============================================================================
+void ThelassicAudioProcessor::setLeanMode(bool shouldBeLean)
+{
+    //whatever a restored state asked for is overruled
+    pendingLeanMode.store(-1);
+    applyLeanMode(shouldBeLean);
+}
+
+void ThelassicAudioProcessor::applyLeanMode(bool shouldBeLean)
+{
+    apvts.state.setProperty("LeanMode", shouldBeLean, nullptr);
+    
+    if (leanMode == shouldBeLean)
+        return;
+    
+    leanMode = shouldBeLean;
+    updateAnalyzerTap();
+}
+
+void ThelassicAudioProcessor::analyzerOpened()
+{
+    //outside lean mode the tap is always running, so there's nothing to do
+    if (++numOpenAnalyzers == 1 && leanMode)
+        updateAnalyzerTap();
+}
+
+void ThelassicAudioProcessor::analyzerClosed()
+{
+    jassert(numOpenAnalyzers > 0);
+    
+    if (--numOpenAnalyzers == 0 && leanMode)
+        updateAnalyzerTap();
+}
+
+void ThelassicAudioProcessor::updateAnalyzerTap()
+{
+    using namespace juce;
+    
+    if (leanMode)
+        analyzerPlan.reset();
+    else if (analyzerPlan == nullptr)
+        analyzerPlan = analyzerPlanCache->getPlan(FFTOrder::order2048, dsp::WindowingFunction<float>::blackmanHarris);
+    
+    if (tapBlockSize <= 0 || (leanMode && numOpenAnalyzers == 0))
+    {
+        leftChannelFifo.release();
+        rightChannelFifo.release();
+        return;
+    }
+    
+    auto numSlots = SingleChannelSimpleFifo<BlockType>::fifoCapacity;
+    
+    if (leanMode)
+    {
+        //enough blocks to span the longest gap between analyzer updates (every 4th frame at 60 Hz),
+        //plus the block being filled and the one AbstractFifo keeps free
+        const auto longestGapSeconds = 4.0 / 60.0;
+        const auto blocksPerGap = (int)std::ceil(tapSampleRate * longestGapSeconds / tapBlockSize);
+        numSlots = jlimit(2, numSlots, blocksPerGap + 2);
+    }
+    
+    leftChannelFifo.prepare(tapBlockSize, numSlots);
+    rightChannelFifo.prepare(tapBlockSize, numSlots);
+}
+
+ThelassicAudioProcessor::MemoryUsage ThelassicAudioProcessor::getMemoryUsage() const
+{
+    MemoryUsage usage;
+    
+    usage.processor = sizeof(*this);
+    usage.analyzerTap = leftChannelFifo.getMemoryUsage() + rightChannelFifo.getMemoryUsage();
+    
+    if (auto* editor = dynamic_cast<ThelassicAudioProcessorEditor*>(getActiveEditor()))
+        usage.editor = editor->getMemoryUsage();
+    
+    usage.sharedPlans = analyzerPlanCache->getMemoryUsage();
+    usage.sharedCoefficients = coefficientCache->getMemoryUsage();
+    
+    return usage;
+}
+
+juce::String ThelassicAudioProcessor::MemoryUsage::toString() const
+{
+    using namespace juce;
+    
+    String str;
+    str << "processor " << File::descriptionOfSizeInBytes((int64)processor)
+        << ", analyzer tap " << File::descriptionOfSizeInBytes((int64)analyzerTap)
+        << ", editor " << File::descriptionOfSizeInBytes((int64)editor)
+        << ", instance total " << File::descriptionOfSizeInBytes((int64)getInstanceTotal())
+        << " (shared fft plans " << File::descriptionOfSizeInBytes((int64)sharedPlans)
+        << ", shared coefficients " << File::descriptionOfSizeInBytes((int64)sharedCoefficients) << ")";
+    return str;
 }
 
 void ThelassicAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    channelWorkers.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -126,11 +257,16 @@ bool ThelassicAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
     // Some plugin hosts, such as certain GarageBand versions, will only
     // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Hosts that don't negotiate get the stereo default from the constructor.
+    // Past that, whatever layout the host offers goes, up to third order
+    // ambisonics and the bigger immersive formats, as long as the project
+    // sets no fixed channel configurations. Mid/side and the second band set
+    // only apply to the first two channels, the rest run the first band set.
+    const auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (numChannels < 1 || numChannels > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -144,7 +280,57 @@ bool ThelassicAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 }
 #endif
 
-void ThelassicAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+template<typename SampleType>
+void ThelassicAudioProcessor::processFilters(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto inputIsSilent = isSilent(block);
+    
+    //offline, wide buses are split between the workers. checked every block, as hosts can
+    //go back to realtime without preparing again
+    const auto useWorkers = isNonRealtime() && channelWorkers.getNumWorkers() > 0;
+    auto forEachGroup = [this, useWorkers](size_t numChannels, auto&& job)
+    {
+        if (useWorkers)
+            channelWorkers.forEachGroup(numChannels, job);
+        else
+            job(size_t(0), numChannels);
+    };
+    
+    //the biquads encode and decode mid/side as they interleave, the other engines need it done around them
+    const auto needsMidSidePass = midSideActive.load(std::memory_order_relaxed) && (linearPhaseActive || svfActive);
+    
+    if (needsMidSidePass)
+        encodeMidSide(block);
+    
+    if (linearPhaseActive)
+    {
+        silentSamples = inputIsSilent ? silentSamples + (juce::int64)block.getNumSamples() : 0;
+        
+        //once the whole impulse has seen nothing but silence, its output is silence too.
+        //a new impulse only goes live while being processed though, so keep going until it has
+        if (silentSamples <= linearPhaseEQ.getTailSamples() || ! linearPhaseEQ.isImpulseLive())
+        {
+            forEachGroup(block.getNumChannels(), [this, &block](size_t first, size_t count)
+            {
+                linearPhaseEQ.processChannels(block, first, count);
+            });
+        }
+    }
+    else if (svfActive)
+    {
+        getSvf<SampleType>().process(block, inputIsSilent, forEachGroup);
+    }
+    else
+    {
+        getCascade<SampleType>().process(block, inputIsSilent, forEachGroup);
+    }
+    
+    if (needsMidSidePass)
+        decodeMidSide(block);
+}
+
+template<typename SampleType>
+void ThelassicAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer, bool hostBypassed)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -159,24 +345,84 @@ void ThelassicAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     for (auto i = totalNumInputChannels; i < totalNumInputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    updateLinearPhaseMode();
+    updateFilterTopology();
     updateFilters();
+    updateBypass<SampleType>(hostBypassed);
     
-    juce::dsp::AudioBlock<float> block (buffer);
-    
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-
-    juce::dsp::ProcessContextReplacing<float> leftContext (leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext (rightBlock);
-    
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    {
+        const ScopedStageTimer filterTimer(filterTiming);
+        
+        juce::dsp::AudioBlock<SampleType> block (buffer);
+        auto& bypass = getBypass<SampleType>();
+        
+        if (bypass.isBypassed())
+        {
+            bypass.processBypassed(block);
+        }
+        else
+        {
+            //the dry path holds at most a prepared block, hosts rarely send more
+            const auto chunkSize = bypass.getMaximumBlockSize();
+            
+            //not prepared yet, there's nowhere to put the dry signal
+            if (chunkSize == 0)
+                return;
+            
+            for (size_t start = 0; start < block.getNumSamples(); start += chunkSize)
+            {
+                auto chunk = block.getSubBlock(start, juce::jmin(chunkSize, block.getNumSamples() - start));
+                
+                bypass.pushInput(chunk);
+                processFilters(chunk);
+                bypass.mix(chunk);
+            }
+        }
+        
+        applyModeSwitchFade(buffer);
+    }
     
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+    {
+        const ScopedStageTimer tapTimer(analyzerTapTiming);
+        
+        const auto midSide = midSideActive.load(std::memory_order_relaxed);
+        
+        leftChannelFifo.update(buffer, midSide);
+        rightChannelFifo.update(buffer, midSide);
+    }
     
 }
 
+void ThelassicAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer, false);
+}
+
+void ThelassicAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer, false);
+}
+
+void ThelassicAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer, true);
+}
+
+void ThelassicAudioProcessor::processBlockBypassed (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer, true);
+}
+
+juce::AudioProcessorParameter* ThelassicAudioProcessor::getBypassParameter() const
+{
+    return apvts.getParameter("Bypass");
+}
+
+bool ThelassicAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 //==============================================================================
 bool ThelassicAudioProcessor::hasEditor() const
 {
@@ -208,88 +454,218 @@ void ThelassicAudioProcessor::setStateInformation (const void* data, int sizeInB
     if (tree.isValid())
     {
         apvts.replaceState(tree);
-        updateFilters();
+        
+        //the audio thread picks the new settings up on its next block
+        designIsStale = true;
+        
+        //hosts can restore state from any thread, but the analyzer tap is only rebuilt on the message thread
+        pendingLeanMode.store((bool)tree.getProperty("LeanMode", false) ? 1 : 0);
+        triggerAsyncUpdate();
+        
+        if (juce::MessageManager::existsAndIsCurrentThread())
+            handleUpdateNowIfNeeded();
     }
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+void ThelassicAudioProcessor::updateFilters()
 {
-    ChainSettings settings;
+    auto chainSettings = chainParameters.load();
+    const auto midSide = juce::roundToInt(apvts.getRawParameterValue("Stereo Mode")->load()) == 1;
+    const auto unlinked = apvts.getRawParameterValue("Channels Unlinked")->load() > 0.5f;
+    
+    //linked stereo runs everything off the first parameter set, so the second isn't even read.
+    //unlinked sets that happen to match still design once, channelsDiffer stays false
+    const auto secondChainSettings = midSide || unlinked ? secondChainParameters.load() : chainSettings;
+    
+    //only redesign when something actually moved
+    const auto isStale = designIsStale.exchange(false);
+    if (! isStale && chainSettings == lastChainSettings && secondChainSettings == lastSecondChainSettings
+        && midSide == midSideActive.load())
+        return;
+    
+    midSideActive.store(midSide);
+    channelsDiffer = secondChainSettings != chainSettings;
+    
+    designCascade(chainSettings, getSampleRate(), design, coefficientCache.get());
+    
+    if (channelsDiffer)
+        designCascade(secondChainSettings, getSampleRate(), secondDesign, coefficientCache.get());
+    
+    const auto& second = channelsDiffer ? secondDesign : design;
+    
+    //only the precision in use runs, so only it would ever finish a crossfade
+    if (isUsingDoublePrecision())
+    {
+        doubleCascade.setDesign(design, second, midSide);
+        doubleSvf.setTargets(chainSettings, secondChainSettings, getSampleRate());
+    }
+    else
+    {
+        floatCascade.setDesign(design, second, midSide);
+        floatSvf.setTargets(chainSettings, secondChainSettings, getSampleRate());
+    }
     
-    settings.loCutFreq = apvts.getRawParameterValue("Lo Cut Freq")->load();
-    settings.hiCutFreq = apvts.getRawParameterValue("Hi Cut Freq")->load();
-    settings.midFreq = apvts.getRawParameterValue("Mid Freq")->load();
-    settings.midGain = apvts.getRawParameterValue("Mid Gain")->load();
-    settings.midQ = apvts.getRawParameterValue("Mid Q")->load();
-    settings.loCutSlope = static_cast<Slope>(apvts.getRawParameterValue("Lo Cut Slope")->load());
-    settings.hiCutSlope = static_cast<Slope>(apvts.getRawParameterValue("Hi Cut Slope")->load());
+    numTopologyCrossfades.store(floatCascade.getNumCrossfades() + doubleCascade.getNumCrossfades());
     
-    settings.loCutBypassed = apvts.getRawParameterValue("Lo Cut Bypassed")->load() > 0.5f;
-    settings.midBypassed = apvts.getRawParameterValue("Mid Bypassed")->load() > 0.5f;
-    settings.hiCutBypassed = apvts.getRawParameterValue("Hi Cut Bypassed")->load() > 0.5f;
+    linearPhaseEQ.setSeparateChannels(channelsDiffer);
     
-    return settings;
+    if (linearPhaseActive)
+        linearPhaseEQ.requestRedesign();
+    
+    lastChainSettings = chainSettings;
+    lastSecondChainSettings = secondChainSettings;
+    updateTailLength();
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+void ThelassicAudioProcessor::updateLinearPhaseMode()
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                               chainSettings.midFreq,
-                                                               chainSettings.midQ,
-                                                               juce::Decibels::decibelsToGain(chainSettings.midGain));
+    linearPhaseWanted = apvts.getRawParameterValue("Linear Phase")->load() > 0.5f;
+    
+    //applyModeSwitchFade() takes the output down first, the engines only swap once it's silent
+    if (linearPhaseWanted == linearPhaseActive || modeSwitchGain > 0.0)
+        return;
+    
+    linearPhaseActive = linearPhaseWanted;
+    linearPhaseEQ.setActive(linearPhaseActive);
+    
+    //the engine taking over has been sitting idle, its state is whatever played before
+    resetFilters();
+    
+    //and the fir may be stale too
+    if (linearPhaseActive)
+        linearPhaseEQ.requestRedesign();
+    
+    updateLatency();
+    silentSamples = 0;
+    updateTailLength();
 }
 
-void ThelassicAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings)
+template<typename SampleType>
+void ThelassicAudioProcessor::applyModeSwitchFade(juce::AudioBuffer<SampleType>& buffer)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    const auto target = linearPhaseWanted == linearPhaseActive ? 1.0 : 0.0;
+    
+    if (modeSwitchGain == target)
+        return;
     
-    leftChain.setBypassed<ChainPositions::Mid>(chainSettings.midBypassed);
-    rightChain.setBypassed<ChainPositions::Mid>(chainSettings.midBypassed);
+    const auto step = target > modeSwitchGain ? modeSwitchStep : -modeSwitchStep;
+    auto gain = modeSwitchGain;
     
-    updateCoefficients(leftChain.get<ChainPositions::Mid>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Mid>().coefficients, peakCoefficients);
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* samples = buffer.getWritePointer(channel);
+        gain = modeSwitchGain;
+        
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            gain = juce::jlimit(0.0, 1.0, gain + step);
+            samples[i] *= (SampleType)gain;
+        }
+    }
+    
+    modeSwitchGain = gain;
 }
 
-void updateCoefficients(Coefficients &old, const Coefficients &replacements)
+void ThelassicAudioProcessor::updateLatency()
 {
-    *old = *replacements;
+    const auto latency = linearPhaseActive ? linearPhaseEQ.getLatencySamples() : 0;
+    
+    floatBypass.setDelay(latency);
+    doubleBypass.setDelay(latency);
+    
+    //hosts expect to hear about latency on the message thread, not from inside processBlock
+    latencyToReport.store(latency);
+    triggerAsyncUpdate();
 }
 
-void ThelassicAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings)
+void ThelassicAudioProcessor::handleAsyncUpdate()
 {
-    auto lowCutCoefficients = makeLoCutFilter(chainSettings, getSampleRate());
+    setLatencySamples(latencyToReport.load());
     
-    auto& leftLowCut = leftChain.get<ChainPositions::LoCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LoCut>();
+    if (const auto lean = pendingLeanMode.exchange(-1); lean >= 0)
+        applyLeanMode(lean == 1);
+}
+
+template<typename SampleType>
+void ThelassicAudioProcessor::updateBypass(bool hostBypassed)
+{
+    const auto shouldBeBypassed = hostBypassed || apvts.getRawParameterValue("Bypass")->load() > 0.5f;
     
-    leftChain.setBypassed<ChainPositions::LoCut>(chainSettings.loCutBypassed);
-    rightChain.setBypassed<ChainPositions::LoCut>(chainSettings.loCutBypassed);
+    //the filters were skipped while bypassed, so they'd pick up from a stale state
+    if (getBypass<SampleType>().setBypassed(shouldBeBypassed))
+        resetFilters();
+}
+
+void ThelassicAudioProcessor::resetFilters()
+{
+    if (linearPhaseActive)
+    {
+        linearPhaseEQ.reset();
+        silentSamples = 0;
+    }
+    else if (svfActive)
+    {
+        floatSvf.reset();
+        doubleSvf.reset();
+    }
+    else
+    {
+        floatCascade.reset();
+        doubleCascade.reset();
+    }
+}
+
+void ThelassicAudioProcessor::updateFilterTopology()
+{
+    const auto shouldUseSvf = apvts.getRawParameterValue("Filter Topology")->load() > 0.5f;
+    
+    if (shouldUseSvf == svfActive)
+        return;
+    
+    svfActive = shouldUseSvf;
     
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.loCutSlope);
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.loCutSlope);
+    //the engine taking over has been sitting idle, so its state is stale
+    if (svfActive)
+    {
+        floatSvf.reset();
+        doubleSvf.reset();
+    }
+    else
+    {
+        floatCascade.reset();
+        doubleCascade.reset();
+    }
 }
 
-void ThelassicAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings)
+void ThelassicAudioProcessor::updateTailLength()
 {
-    auto highCutCoefficients = makeHiCutFilter(chainSettings, getSampleRate());
+    const auto sampleRate = getSampleRate();
+    if (sampleRate <= 0.0)
+        return;
+    
+    auto tailSamples = design.getTailSamples();
     
-    auto& leftHighCut = leftChain.get<ChainPositions::HiCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HiCut>();
+    if (channelsDiffer)
+        tailSamples = juce::jmax(tailSamples, secondDesign.getTailSamples());
     
-    leftChain.setBypassed<ChainPositions::HiCut>(chainSettings.hiCutBypassed);
-    rightChain.setBypassed<ChainPositions::HiCut>(chainSettings.hiCutBypassed);
+    if (linearPhaseActive)
+        tailSamples = (double)linearPhaseEQ.getTailSamples();
     
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.hiCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.hiCutSlope);
+    tailLengthSeconds.store(tailSamples / sampleRate);
 }
 
-void ThelassicAudioProcessor::updateFilters()
+void ThelassicAudioProcessor::fillLinearPhaseResponse(const std::vector<double>& frequencies,
+                                                      std::vector<double>& magnitudes,
+                                                      double sampleRate,
+                                                      int channel)
 {
-    auto chainSettings = getChainSettings(apvts);
+    //called on the design thread, so it designs its own cascade from a fresh parameter snapshot
+    CascadeDesign linearPhaseDesign;
+    designCascade((channel == 0 ? chainParameters : secondChainParameters).load(), sampleRate,
+                  linearPhaseDesign, coefficientCache.get());
     
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    for (size_t i = 0; i < frequencies.size(); ++i)
+        magnitudes[i] = linearPhaseDesign.getMagnitudeForFrequency(frequencies[i], sampleRate);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout
@@ -297,43 +673,34 @@ juce::AudioProcessorValueTreeState::ParameterLayout
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
     
-        layout.add(std::make_unique<juce::AudioParameterFloat>("Lo Cut Freq",
-                                                                "Lo Cut Freq",
-                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.3f),
-                                                                20.f));
-        layout.add(std::make_unique<juce::AudioParameterFloat>("Hi Cut Freq",
-                                                                "Hi Cut Freq",
-                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.22f),
-                                                                20000.f));
-        layout.add(std::make_unique<juce::AudioParameterFloat>("Mid Freq",
-                                                                "Mid Freq",
-                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.22f),
-                                                                1000.f));
-        layout.add(std::make_unique<juce::AudioParameterFloat>("Mid Gain",
-                                                                "Mid Gain",
-                                                                juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                                0.0f));
-        layout.add(std::make_unique<juce::AudioParameterFloat>("Mid Q",
-                                                                "Mid Q",
-                                                                juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                                0.22f));
+        addLegacyBandParameters(layout);
         
-        juce::StringArray stringArray;
-        for( int i = 0; i < 4; ++i )
-        {
-            juce::String str;
-            str << (12 + i*12);
-            str << " db/oct";
-            stringArray.add(str);
-        }
+        layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
+        layout.add(std::make_unique<juce::AudioParameterBool>("Spectrogram Enabled", "Spectrogram Enabled", false));
+        layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Filled", "Analyzer Filled", false));
+        layout.add(std::make_unique<juce::AudioParameterBool>("Linear Phase", "Linear Phase", false));
         
-        layout.add(std::make_unique<juce::AudioParameterChoice>("Lo Cut Slope", "Lo Cut Slope", stringArray, 0));
-        layout.add(std::make_unique<juce::AudioParameterChoice>("Hi Cut Slope", "Hi Cut Slope", stringArray, 0));
+        addBandParameters(layout);
         
-        layout.add(std::make_unique<juce::AudioParameterBool>("Lo Cut Bypassed", "Lo Cut Bypassed", false));
-        layout.add(std::make_unique<juce::AudioParameterBool>("Mid Bypassed", "Mid Bypassed", false));
-        layout.add(std::make_unique<juce::AudioParameterBool>("Hi Cut Bypassed", "Hi Cut Bypassed", false));
-        layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
+        //svf is for bands that are modulated hard, it follows parameter changes sample by sample
+        layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Topology", "Filter Topology",
+                                                                juce::StringArray {"Biquad", "SVF"}, 0));
+        
+        //the host's bypass, see getBypassParameter()
+        layout.add(std::make_unique<juce::AudioParameterBool>("Bypass", "Bypass", false));
+        
+        //mid/side runs the "Ch2 " bands on the side, everything else on the mid. another choice
+        //would shift what saved normalised values mean, so a new mode needs a parameter of its own
+        layout.add(std::make_unique<juce::AudioParameterChoice>("Stereo Mode", "Stereo Mode",
+                                                                juce::StringArray {"Stereo", "Mid/Side"}, 0));
+        addBandParameters(layout, 1);
+        
+        //new parameters rather than longer choice lists, see numSlopeChoices
+        addCutParameters(layout);
+        
+        //left/right: the "Ch2 " bands run on the right channel and the first set on the left.
+        //mid/side already splits the sets, so it takes precedence
+        layout.add(std::make_unique<juce::AudioParameterBool>("Channels Unlinked", "Channels Unlinked", false));
 
     return layout;
 }
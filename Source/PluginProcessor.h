@@ -10,16 +10,116 @@
 
 #include <JuceHeader.h>
 #include <array>
+#include <atomic>
+#include "FFTPlanCache.h"
+#include "LinearPhaseEQ.h"
+#include "EQBands.h"
+#include "CrossfadingCascade.h"
+#include "SvfCascade.h"
+#include "CoefficientCache.h"
+#include "BypassCrossfade.h"
+#include "ChannelWorkerPool.h"
 
-template<typename T>
+/*
+ running average and peak of how long a pipeline stage takes.
+ written from one thread (audio or message), readable from any other.
+ */
+struct StageTiming
+{
+    void addSample(double milliseconds)
+    {
+        auto ms = (float)milliseconds;
+        auto average = averageMs.load(std::memory_order_relaxed);
+        
+        //the first sample seeds the average, so rare events don't read as near zero
+        if (numSamples.fetch_add(1, std::memory_order_relaxed) == 0)
+            averageMs.store(ms, std::memory_order_relaxed);
+        else
+            averageMs.store(average + 0.05f * (ms - average), std::memory_order_relaxed);
+        
+        if (ms > peakMs.load(std::memory_order_relaxed))
+            peakMs.store(ms, std::memory_order_relaxed);
+        
+        lastMs.store(ms, std::memory_order_relaxed);
+    }
+    
+    float getAverageMs() const {return averageMs.load(std::memory_order_relaxed);}
+    float getPeakMs() const {return peakMs.load(std::memory_order_relaxed);}
+    float getLastMs() const {return lastMs.load(std::memory_order_relaxed);}
+    juce::uint32 getNumSamples() const {return numSamples.load(std::memory_order_relaxed);}
+    void resetPeak() {peakMs.store(0.f, std::memory_order_relaxed);}
+    
+private:
+    std::atomic<float> averageMs {0.f}, peakMs {0.f}, lastMs {0.f};
+    std::atomic<juce::uint32> numSamples {0};
+};
+
+struct ScopedStageTimer
+{
+    explicit ScopedStageTimer(StageTiming& t) : timing(t), start(juce::Time::getHighResolutionTicks()) {}
+    
+    ~ScopedStageTimer()
+    {
+        timing.addSample(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0);
+    }
+    
+private:
+    StageTiming& timing;
+    juce::int64 start;
+};
+
+/*
+ a snapshot of a fifo's traffic. a drop is a write that found no free slot.
+ */
+struct FifoCounters
+{
+    juce::uint32 pushes = 0, pulls = 0, drops = 0;
+    int numReady = 0;
+};
+
+inline size_t getAllocatedBytes(const juce::AudioBuffer<float>& buffer)
+{
+    return size_t(buffer.getNumChannels() * buffer.getNumSamples()) * sizeof(float);
+}
+
+inline size_t getAllocatedBytes(const std::vector<float>& buffer)
+{
+    return buffer.capacity() * sizeof(float);
+}
+
+/*
+ single producer, single consumer fifo of preallocated slots.
+ the producer fills the next free slot in place and commits it, the consumer reads (or swaps out)
+ the oldest slot in place and releases it, so nothing is copied or reallocated on the way through.
+ as with juce::AbstractFifo, one of the 'Capacity' slots is always kept free.
+ */
+template<typename T, int Capacity>
 struct Fifo
 {
+    static_assert(Capacity >= 2, "a Fifo needs at least two slots to hold one item");
+    
+    /*
+     only the first 'numSlots' slots are used (and allocated by prepare()), for callers
+     that know they need fewer than 'Capacity'. empties the fifo.
+     */
+    void setNumSlots(int numSlots)
+    {
+        jassert(2 <= numSlots && numSlots <= Capacity);
+        activeSlots = juce::jlimit(2, Capacity, numSlots);
+        fifo.setTotalSize(activeSlots);
+    }
+    
+    int getNumSlots() const {return activeSlots;}
+    
     void prepare(int numChannels, int numSamples)
     {
         static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
                       "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
-        for( auto& buffer : buffers)
+        resetAndFreeUnusedSlots();
+        
+        for (int i = 0; i < activeSlots; ++i)
         {
+            auto& buffer = buffers[(size_t)i];
             buffer.setSize(numChannels,
                            numSamples,
                            false,   //clear everything?
@@ -33,45 +133,100 @@ struct Fifo
     {
         static_assert( std::is_same_v<T, std::vector<float>>,
                       "prepare(numElements) should only be used when the Fifo is holding std::vector<float>");
-        for( auto& buffer : buffers )
+        resetAndFreeUnusedSlots();
+        
+        for (int i = 0; i < activeSlots; ++i)
         {
-            buffer.clear();
-            buffer.resize(numElements, 0);
+            buffers[(size_t)i].assign(numElements, 0.f);
         }
     }
     
-    bool push(const T& t)
+    //frees every slot and empties the fifo. prepare() brings it back.
+    void release()
     {
-        auto write = fifo.write(1);
-        if( write.blockSize1 > 0 )
-        {
-            buffers[write.startIndex1] = t;
-            return true;
-        }
+        for (auto& buffer : buffers)
+            buffer = T();
         
-        return false;
+        fifo.reset();
     }
     
-    bool pull(T& t)
+    //bytes allocated by the slots
+    size_t getMemoryUsage() const
     {
-        auto read = fifo.read(1);
-        if( read.blockSize1 > 0 )
-        {
-            t = buffers[read.startIndex1];
-            return true;
-        }
+        size_t bytes = 0;
+        for (const auto& buffer : buffers)
+            bytes += getAllocatedBytes(buffer);
         
-        return false;
+        return bytes;
+    }
+    
+    /*
+     returns the next free slot to fill, or nullptr if the fifo is full.
+     calling it again before commitWrite() hands back the same slot.
+     */
+    T* acquireWrite()
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        
+        if (size1 > 0)
+            return &buffers[(size_t)start1];
+        
+        numDrops.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    
+    void commitWrite()
+    {
+        fifo.finishedWrite(1);
+        numPushes.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    /*
+     returns the oldest ready slot, or nullptr if there's nothing to read.
+     the consumer owns the slot until releaseRead(), so it may also swap its contents out.
+     */
+    T* acquireRead()
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+        return size1 > 0 ? &buffers[(size_t)start1] : nullptr;
+    }
+    
+    void releaseRead()
+    {
+        fifo.finishedRead(1);
+        numPulls.fetch_add(1, std::memory_order_relaxed);
     }
     
     int getNumAvailableForReading() const
     {
         return fifo.getNumReady();
     }
+    
+    FifoCounters getCounters() const
+    {
+        FifoCounters counters;
+        counters.pushes = numPushes.load(std::memory_order_relaxed);
+        counters.pulls = numPulls.load(std::memory_order_relaxed);
+        counters.drops = numDrops.load(std::memory_order_relaxed);
+        counters.numReady = fifo.getNumReady();
+        return counters;
+    }
 private:
-    static constexpr int Capacity = 30;
     std::array<T, Capacity> buffers;
+    int activeSlots = Capacity;
+    
+    void resetAndFreeUnusedSlots()
+    {
+        for (int i = activeSlots; i < Capacity; ++i)
+            buffers[(size_t)i] = T();
+        
+        fifo.reset();
+    }
+
     juce::AbstractFifo fifo {Capacity};
+    std::atomic<juce::uint32> numPushes {0}, numPulls {0}, numDrops {0};
 };
 
 enum Channel
@@ -88,156 +243,117 @@ struct SingleChannelSimpleFifo
         prepared.set(false);
     }
     
-    void update(const BlockType& buffer)
+    /*
+     double blocks are narrowed to float on the way in, the analyzer doesn't need more.
+     with 'midSide' the left fifo gets the mid of the first two channels and the right the side.
+     */
+    template<typename SampleType>
+    void update(const juce::AudioBuffer<SampleType>& buffer, bool midSide = false)
     {
-        jassert(prepared.get());
+        //prepare() and release() hold the lock, the audio thread just skips this block
+        const juce::SpinLock::ScopedTryLockType lock(tapLock);
+        if (! lock.isLocked() || ! prepared.get())
+            return;
+        
         jassert(buffer.getNumChannels() > channelToUse);
         auto* channelPtr = buffer.getReadPointer(channelToUse);
         
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        const auto numSamples = buffer.getNumSamples();
+        const auto bufferSize = size.get();
+        
+        //copy straight into the slot being filled, committing it each time it's full
+        for (int i = 0; i < numSamples; )
         {
-            pushNextSampleIntoFifo(channelPtr[i]);
+            if (slotToFill == nullptr)
+            {
+                slotToFill = audioBufferFifo.acquireWrite();
+                
+                if (slotToFill == nullptr)
+                    return;     //the editor isn't keeping up, drop the rest of this block
+                
+                fifoIndex = 0;
+            }
+            
+            auto numToCopy = juce::jmin(numSamples - i, bufferSize - fifoIndex);
+            auto* slotPtr = slotToFill->getWritePointer(0, fifoIndex);
+            
+            if (midSide && buffer.getNumChannels() > 1)
+            {
+                auto* first = buffer.getReadPointer(0, i);
+                auto* second = buffer.getReadPointer(1, i);
+                
+                if (channelToUse == Channel::Left)
+                    std::transform(first, first + numToCopy, second, slotPtr, [](SampleType a, SampleType b) {return float((a + b) * SampleType(0.5));});
+                else
+                    std::transform(first, first + numToCopy, second, slotPtr, [](SampleType a, SampleType b) {return float((a - b) * SampleType(0.5));});
+            }
+            else if constexpr (std::is_same_v<SampleType, float>)
+                juce::FloatVectorOperations::copy(slotPtr, channelPtr + i, numToCopy);
+            else
+                std::transform(channelPtr + i, channelPtr + i + numToCopy, slotPtr, [](SampleType x) {return (float)x;});
+            
+            fifoIndex += numToCopy;
+            i += numToCopy;
+            
+            if (fifoIndex == bufferSize)
+            {
+                audioBufferFifo.commitWrite();
+                slotToFill = nullptr;
+            }
         }
     }
     
-    void prepare(int bufferSize)
+    void prepare(int bufferSize, int numSlots = fifoCapacity)
     {
+        const juce::SpinLock::ScopedLockType lock(tapLock);
+        
         prepared.set(false);
         size.set(bufferSize);
         
-        bufferToFill.setSize(1,             //channel
-                             bufferSize,    //num samples
-                             false,         //keepEskistingContent
-                             true,          //clear extra space
-                             true);         //avoid re allocating
+        audioBufferFifo.setNumSlots(numSlots);
         audioBufferFifo.prepare(1, bufferSize);
+        slotToFill = nullptr;
         fifoIndex = 0;
         prepared.set(true);
     }
     
+    //frees every slot, update() ignores incoming audio until the next prepare()
+    void release()
+    {
+        const juce::SpinLock::ScopedLockType lock(tapLock);
+        
+        prepared.set(false);
+        audioBufferFifo.release();
+        slotToFill = nullptr;
+        fifoIndex = 0;
+    }
+    
+    size_t getMemoryUsage() const {return audioBufferFifo.getMemoryUsage();}
+    
+    static constexpr int fifoCapacity = 30;
+    
     int getNumCompleteBuffersAvailable() const {return audioBufferFifo.getNumAvailableForReading();}
     bool isPrepared() const {return prepared.get();}
     int getSize() const {return size.get();}
+    FifoCounters getCounters() const {return audioBufferFifo.getCounters();}
     
-    bool getAudioBuffer(BlockType& buf) {return audioBufferFifo.pull(buf);}
+    //read the oldest complete buffer in place, then hand it back with releaseAudioBuffer()
+    BlockType* acquireAudioBuffer() {return audioBufferFifo.acquireRead();}
+    void releaseAudioBuffer() {audioBufferFifo.releaseRead();}
 private:
     Channel channelToUse;
     int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
+    Fifo<BlockType, fifoCapacity> audioBufferFifo;
+    BlockType* slotToFill = nullptr;
     juce::Atomic<bool> prepared = false;
     juce::Atomic<int> size = 0;
-    
-    void pushNextSampleIntoFifo(float sample)
-    {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-            
-            juce::ignoreUnused(ok);
-            
-            fifoIndex = 0;
-        }
-        
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
-    
+    juce::SpinLock tapLock;
 };
 
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-};
-
-struct ChainSettings
-{
-    float midFreq { 0 }, midGain { 0 }, midQ { 1.f };
-    float loCutFreq { 0 }, hiCutFreq { 0 };
-    Slope loCutSlope { Slope::Slope_12 }, hiCutSlope { Slope::Slope_12 };
-    
-    bool loCutBypassed { false },
-         midBypassed { false },
-         hiCutBypassed { false };
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
-using Filter = juce::dsp::IIR::Filter<float>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-
-enum ChainPositions
-{
-    LoCut,
-    Mid,
-    HiCut
-};
-
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
-{
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain,
-                     const CoefficientType& coefficients,
-                     const Slope& slope)
-{
-    
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
-    
-    switch(slope)
-    {
-        case Slope_48:
-        {
-            update<3>(chain, coefficients);
-        }
-        case Slope_36:
-        {
-            update<2>(chain, coefficients);
-        }
-        case Slope_24:
-        {
-            update<1>(chain, coefficients);
-        }
-        case Slope_12:
-        {
-            update<0>(chain, coefficients);
-        }
-    }
-}
-
-inline auto makeLoCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.loCutFreq,
-                                                                                       sampleRate,
-                                                                                       2 *(chainSettings.loCutSlope + 1));
-}
-
-inline auto makeHiCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.hiCutFreq,
-                                                                               sampleRate,
-                                                                               2 *(chainSettings.hiCutSlope + 1));
-}
-
 //==============================================================================
 
-class ThelassicAudioProcessor  : public juce::AudioProcessor
+class ThelassicAudioProcessor  : public juce::AudioProcessor,
+                                 private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -253,6 +369,16 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    //hosts that bypass without the parameter get the same fade and latency as hosts that use it
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+    
+    //the cascade runs natively in either precision, doubles skip the host's conversion
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -283,15 +409,198 @@ public:
     using BlockType = juce::AudioBuffer<float>;
     SingleChannelSimpleFifo<BlockType> leftChannelFifo {Channel::Left};
     SingleChannelSimpleFifo<BlockType> rightChannelFifo {Channel::Right};
+    
+    //time spent feeding both analyzer fifos in processBlock
+    const StageTiming& getAnalyzerTapTiming() const {return analyzerTapTiming;}
+    
+    //time spent in the eq itself, crossfades included
+    const StageTiming& getFilterTiming() const {return filterTiming;}
+    
+    //slope, bypass and band count changes crossfaded so far
+    int getNumTopologyCrossfades() const {return numTopologyCrossfades.load();}
+    
+    /*
+     bytes held by this instance. the fft plans in FFTPlanCache and the CoefficientCache are
+     shared by every instance in the process, so they're reported separately and not part of
+     getInstanceTotal().
+     the editor's share is only known while one is open. call on the message thread.
+     */
+    struct MemoryUsage
+    {
+        size_t processor = 0;       //the processor itself, filter state included
+        size_t analyzerTap = 0;     //audio queued for the analyzer
+        size_t editor = 0;          //the open editor's fft frames, traces and images
+        size_t sharedPlans = 0;     //process wide
+        size_t sharedCoefficients = 0;
+        
+        size_t getInstanceTotal() const {return processor + analyzerTap + editor;}
+        juce::String toString() const;
+    };
+    
+    MemoryUsage getMemoryUsage() const;
+    
+    /*
+     lean mode sizes the analyzer tap to the fewest slots that cover a slow display frame,
+     allocates it only while an editor is open and doesn't keep fft plans alive without one,
+     which is what getMemoryUsage()'s analyzerTap and sharedPlans shrink by.
+     users turn it on with the "lean" button in the editor's top row. it's saved with the
+     plugin state, so a preset or template saved with it on brings every instance up lean.
+     setStateInformation() applies the saved setting on the message thread, whichever thread
+     the host restores from. call on the message thread.
+     */
+    void setLeanMode(bool shouldBeLean);
+    bool isLeanMode() const {return leanMode;}
+    
+    //editors call these as their analyzers open and close, on the message thread
+    void analyzerOpened();
+    void analyzerClosed();
+    
+    bool isLinearPhaseActive() const {return linearPhaseActive;}
+    
+    //false while linear phase is on but its impulse isn't live yet, and the output is silence. call it
+    //from the thread calling processBlock()
+    bool isLinearPhaseReady() const {return ! linearPhaseActive || linearPhaseEQ.isImpulseLive();}
+    
+    //editor construction to its first painted frame, across every editor this instance has opened
+    StageTiming& getEditorOpenTiming() {return editorOpenTiming;}
 private:
-    MonoChain leftChain, rightChain;
+    StageTiming editorOpenTiming;
+
+    StageTiming analyzerTapTiming;
+    StageTiming filterTiming;
+    std::atomic<int> numTopologyCrossfades {0};
+    
+    bool leanMode = false;
+    int numOpenAnalyzers = 0;
+    double tapSampleRate = 0.0;
+    int tapBlockSize = 0;
+    
+    void updateAnalyzerTap();
+    
+    //keeps the editors' default analyzer plan alive, so opening an editor builds no tables
+    juce::SharedResourcePointer<FFTPlanCache> analyzerPlanCache;
+    FFTPlanCache::PlanPtr analyzerPlan;
+    
+    juce::SharedResourcePointer<CoefficientCache> coefficientCache;
+    ChainParameters chainParameters {apvts};
+    ChainSettings lastChainSettings;
+    std::atomic<bool> designIsStale {true};
+    
+    //the "Ch2 " parameters, for the side in mid/side or the right channel in left/right
+    ChainParameters secondChainParameters {apvts, 1};
+    ChainSettings lastSecondChainSettings;
+    std::atomic<bool> midSideActive {false};
+    bool channelsDiffer = false;
+    
+    CascadeDesign design, secondDesign;
+    CrossfadingCascade<float> floatCascade;
+    CrossfadingCascade<double> doubleCascade;
+    
+    template<typename SampleType>
+    CrossfadingCascade<SampleType>& getCascade()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleCascade;
+        else
+            return floatCascade;
+    }
+    
+    //the same bands as state variable filters, for when "Filter Topology" is "SVF"
+    SvfCascade<float> floatSvf;
+    SvfCascade<double> doubleSvf;
+    bool svfActive = false;
+    
+    template<typename SampleType>
+    SvfCascade<SampleType>& getSvf()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleSvf;
+        else
+            return floatSvf;
+    }
+    
+    void updateFilterTopology();
+    
+    //fades in and out of "Bypass", once faded out the filters don't run at all
+    BypassCrossfade<float> floatBypass;
+    BypassCrossfade<double> doubleBypass;
+    
+    template<typename SampleType>
+    BypassCrossfade<SampleType>& getBypass()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleBypass;
+        else
+            return floatBypass;
+    }
+    
+    template<typename SampleType>
+    void updateBypass(bool hostBypassed);
+    
+    //clears whichever engine is running, for when it starts again after being skipped
+    void resetFilters();
+    
+    //the widest bus isBusesLayoutSupported() takes
+    static constexpr int maxChannels = 64;
+    
+    //shares the channels of offline renders out, see processFilters()
+    ChannelWorkerPool channelWorkers;
+    
+    //the same curve as the chains, as a linear-phase FIR. only runs when "Linear Phase" is on.
+    LinearPhaseEQ linearPhaseEQ {[this](const std::vector<double>& frequencies,
+                                        std::vector<double>& magnitudes,
+                                        double sampleRate,
+                                        int channel)
+    {
+        fillLinearPhaseResponse(frequencies, magnitudes, sampleRate, channel);
+    }};
+    
+    bool linearPhaseActive = false;
+    
+    /*
+     the two modes have different latencies, so their outputs can't be crossfaded. instead a
+     "Linear Phase" change takes the output down to silence over BypassCrossfade's fade time,
+     swaps the engines and latency at the bottom, then brings it back up.
+     */
+    bool linearPhaseWanted = false;
+    double modeSwitchGain = 1.0, modeSwitchStep = 1.0;
+    
+    template<typename SampleType>
+    void applyModeSwitchFade(juce::AudioBuffer<SampleType>& buffer);
+    
+    //how long the input has been digital silence, only counted while linear phase runs
+    juce::int64 silentSamples = 0;
+    
+    //read by the host off the audio thread
+    std::atomic<double> tailLengthSeconds {0.0};
+    void updateTailLength();
     
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    void fillLinearPhaseResponse(const std::vector<double>& frequencies,
+                                 std::vector<double>& magnitudes,
+                                 double sampleRate,
+                                 int channel);
+    void updateLinearPhaseMode();
     
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    //delays the bypassed signal to match the current mode's latency, and has the message thread report it
+    void updateLatency();
+    
+    std::atomic<int> latencyToReport {0};
+    
+    //the lean mode a restored state asked for, -1 once it's been applied or overruled
+    std::atomic<int> pendingLeanMode {-1};
+    void applyLeanMode(bool shouldBeLean);
+    
+    //reports the latency, and applies any restored lean mode
+    void handleAsyncUpdate() override;
     
     void updateFilters();
+    
+    //everything processBlock does, for both precisions
+    template<typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer, bool hostBypassed);
+    
+    template<typename SampleType>
+    void processFilters(const juce::dsp::AudioBlock<SampleType>& block);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThelassicAudioProcessor)
@@ -0,0 +1,337 @@
+/*
+  ==============================================================================
+
+    SimdRealFFT.cpp
+    Self-contained SIMD real-input FFT for the analyzer.
+
+  ==============================================================================
+*/
+
+#include "SimdRealFFT.h"
+#include <cmath>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+#if JUCE_ARM && (defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64))
+ #include <arm_neon.h>
+ #define THELASSIC_FFT_NEON 1
+#else
+ #define THELASSIC_FFT_NEON 0
+#endif
+
+//==============================================================================
+//stages with a stride below this get twiddles expanded to one per element (the widest vector is 8)
+static constexpr int narrowStageLimit = 8;
+
+namespace ScalarKernel
+{
+    using Vec = float;
+    static constexpr int vecWidth = 1;
+    
+    static inline Vec load(const float* p) {return *p;}
+    static inline void store(float* p, Vec v) {*p = v;}
+    static inline Vec broadcast(float v) {return v;}
+    static inline Vec add(Vec a, Vec b) {return a + b;}
+    static inline Vec sub(Vec a, Vec b) {return a - b;}
+    static inline Vec mul(Vec a, Vec b) {return a * b;}
+    static inline Vec mulAdd(Vec acc, Vec a, Vec b) {return acc + a * b;}
+    static inline Vec mulSub(Vec acc, Vec a, Vec b) {return acc - a * b;}
+    static inline void storeInterleaved(float*, Vec, Vec, int) {jassertfalse;}
+    
+    #include "SimdRealFFTKernel.inl"
+}
+
+#if JUCE_INTEL
+namespace SSE2Kernel
+{
+    using Vec = __m128;
+    static constexpr int vecWidth = 4;
+    
+    static inline Vec load(const float* p) {return _mm_loadu_ps(p);}
+    static inline void store(float* p, Vec v) {_mm_storeu_ps(p, v);}
+    static inline Vec broadcast(float v) {return _mm_set1_ps(v);}
+    static inline Vec add(Vec a, Vec b) {return _mm_add_ps(a, b);}
+    static inline Vec sub(Vec a, Vec b) {return _mm_sub_ps(a, b);}
+    static inline Vec mul(Vec a, Vec b) {return _mm_mul_ps(a, b);}
+    static inline Vec mulAdd(Vec acc, Vec a, Vec b) {return _mm_add_ps(acc, _mm_mul_ps(a, b));}
+    static inline Vec mulSub(Vec acc, Vec a, Vec b) {return _mm_sub_ps(acc, _mm_mul_ps(a, b));}
+    
+    //writes s chunk of 'sums', s chunk of 'diffs', and so on
+    static inline void storeInterleaved(float* dest, Vec sums, Vec diffs, int chunk)
+    {
+        if (chunk == 1)
+        {
+            _mm_storeu_ps(dest,     _mm_unpacklo_ps(sums, diffs));
+            _mm_storeu_ps(dest + 4, _mm_unpackhi_ps(sums, diffs));
+        }
+        else
+        {
+            _mm_storeu_ps(dest,     _mm_movelh_ps(sums, diffs));
+            _mm_storeu_ps(dest + 4, _mm_movehl_ps(diffs, sums));
+        }
+    }
+    
+    #include "SimdRealFFTKernel.inl"
+}
+
+//the avx2 kernel is compiled for avx2 + fma regardless of the project's baseline flags,
+//and only ever called after the runtime cpu check
+#if JUCE_CLANG
+ #pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif JUCE_GCC
+ #pragma GCC push_options
+ #pragma GCC target ("avx2,fma")
+#endif
+
+namespace AVX2Kernel
+{
+    using Vec = __m256;
+    static constexpr int vecWidth = 8;
+    
+    static inline Vec load(const float* p) {return _mm256_loadu_ps(p);}
+    static inline void store(float* p, Vec v) {_mm256_storeu_ps(p, v);}
+    static inline Vec broadcast(float v) {return _mm256_set1_ps(v);}
+    static inline Vec add(Vec a, Vec b) {return _mm256_add_ps(a, b);}
+    static inline Vec sub(Vec a, Vec b) {return _mm256_sub_ps(a, b);}
+    static inline Vec mul(Vec a, Vec b) {return _mm256_mul_ps(a, b);}
+    static inline Vec mulAdd(Vec acc, Vec a, Vec b) {return _mm256_fmadd_ps(a, b, acc);}
+    static inline Vec mulSub(Vec acc, Vec a, Vec b) {return _mm256_fnmadd_ps(a, b, acc);}
+    
+    //writes s chunk of 'sums', s chunk of 'diffs', and so on
+    static inline void storeInterleaved(float* dest, Vec sums, Vec diffs, int chunk)
+    {
+        Vec lo, hi;
+        
+        if (chunk == 1)
+        {
+            lo = _mm256_unpacklo_ps(sums, diffs);
+            hi = _mm256_unpackhi_ps(sums, diffs);
+        }
+        else if (chunk == 2)
+        {
+            lo = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(sums), _mm256_castps_pd(diffs)));
+            hi = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(sums), _mm256_castps_pd(diffs)));
+        }
+        else
+        {
+            lo = sums;
+            hi = diffs;
+        }
+        
+        //the unpacks work within 128 bit lanes, stitch the lanes back into order
+        _mm256_storeu_ps(dest,     _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dest + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    
+    #include "SimdRealFFTKernel.inl"
+}
+
+#if JUCE_CLANG
+ #pragma clang attribute pop
+#elif JUCE_GCC
+ #pragma GCC pop_options
+#endif
+#endif
+
+#if THELASSIC_FFT_NEON
+namespace NEONKernel
+{
+    using Vec = float32x4_t;
+    static constexpr int vecWidth = 4;
+    
+    static inline Vec load(const float* p) {return vld1q_f32(p);}
+    static inline void store(float* p, Vec v) {vst1q_f32(p, v);}
+    static inline Vec broadcast(float v) {return vdupq_n_f32(v);}
+    static inline Vec add(Vec a, Vec b) {return vaddq_f32(a, b);}
+    static inline Vec sub(Vec a, Vec b) {return vsubq_f32(a, b);}
+    static inline Vec mul(Vec a, Vec b) {return vmulq_f32(a, b);}
+    
+   #if defined (__ARM_FEATURE_FMA) || defined (_M_ARM64)
+    static inline Vec mulAdd(Vec acc, Vec a, Vec b) {return vfmaq_f32(acc, a, b);}
+    static inline Vec mulSub(Vec acc, Vec a, Vec b) {return vfmsq_f32(acc, a, b);}
+   #else
+    //32 bit neon without vfpv4 has no fused multiply-add
+    static inline Vec mulAdd(Vec acc, Vec a, Vec b) {return vmlaq_f32(acc, a, b);}
+    static inline Vec mulSub(Vec acc, Vec a, Vec b) {return vmlsq_f32(acc, a, b);}
+   #endif
+    
+    //writes s chunk of 'sums', s chunk of 'diffs', and so on
+    static inline void storeInterleaved(float* dest, Vec sums, Vec diffs, int chunk)
+    {
+        if (chunk == 1)
+        {
+            auto zipped = vzipq_f32(sums, diffs);
+            vst1q_f32(dest,     zipped.val[0]);
+            vst1q_f32(dest + 4, zipped.val[1]);
+        }
+        else
+        {
+            vst1q_f32(dest,     vcombine_f32(vget_low_f32(sums), vget_low_f32(diffs)));
+            vst1q_f32(dest + 4, vcombine_f32(vget_high_f32(sums), vget_high_f32(diffs)));
+        }
+    }
+    
+    #include "SimdRealFFTKernel.inl"
+}
+#endif
+
+//==============================================================================
+SimdRealFFT::InstructionSet SimdRealFFT::getBestInstructionSet()
+{
+    if (isSupported(InstructionSet::avx2))
+        return InstructionSet::avx2;
+    
+    if (isSupported(InstructionSet::neon))
+        return InstructionSet::neon;
+    
+    if (isSupported(InstructionSet::sse2))
+        return InstructionSet::sse2;
+    
+    return InstructionSet::scalar;
+}
+
+bool SimdRealFFT::isSupported(InstructionSet set)
+{
+    switch (set)
+    {
+        case InstructionSet::scalar:
+            return true;
+       #if JUCE_INTEL
+        case InstructionSet::sse2:
+            return juce::SystemStats::hasSSE2();
+        case InstructionSet::avx2:
+            return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+       #endif
+       #if THELASSIC_FFT_NEON
+        case InstructionSet::neon:
+            return true;
+       #endif
+        default:
+            return false;
+    }
+}
+
+size_t SimdRealFFT::getMemoryUsage() const
+{
+    size_t bytes = sizeof(*this);
+    
+    for (auto* table : {&twiddleRe, &twiddleIm, &narrowTwiddleRe, &narrowTwiddleIm, &splitRe, &splitIm})
+        bytes += table->capacity() * sizeof(float);
+    
+    return bytes;
+}
+
+const char* SimdRealFFT::getName() const
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::sse2: return "simd real fft (sse2)";
+        case InstructionSet::avx2: return "simd real fft (avx2)";
+        case InstructionSet::neon: return "simd real fft (neon)";
+        case InstructionSet::scalar:
+        default:                   return "simd real fft (scalar)";
+    }
+}
+
+SimdRealFFT::SimdRealFFT(int order, InstructionSet set) :
+size(1 << order),
+halfSize(size / 2),
+instructionSet(isSupported(set) ? set : InstructionSet::scalar),
+runStages(ScalarKernel::runStages)
+{
+    jassert(order >= 2);
+    
+    switch (instructionSet)
+    {
+       #if JUCE_INTEL
+        case InstructionSet::sse2: runStages = SSE2Kernel::runStages; break;
+        case InstructionSet::avx2: runStages = AVX2Kernel::runStages; break;
+       #endif
+       #if THELASSIC_FFT_NEON
+        case InstructionSet::neon: runStages = NEONKernel::runStages; break;
+       #endif
+        default: break;
+    }
+    
+    //twiddles are built in double so the tables carry no accumulated error
+    const auto twoPi = juce::MathConstants<double>::twoPi;
+    
+    for (int n = halfSize, s = 1; n >= 2; n /= 2, s *= 2)
+    {
+        for (int p = 0; p < n / 2; ++p)
+        {
+            const auto wr = (float)std::cos(twoPi * p / n);
+            const auto wi = (float)-std::sin(twoPi * p / n);
+            
+            twiddleRe.push_back(wr);
+            twiddleIm.push_back(wi);
+            
+            if (s < narrowStageLimit)
+            {
+                narrowTwiddleRe.insert(narrowTwiddleRe.end(), size_t(s), wr);
+                narrowTwiddleIm.insert(narrowTwiddleIm.end(), size_t(s), wi);
+            }
+        }
+    }
+    
+    for (int k = 0; k <= halfSize / 2; ++k)
+    {
+        splitRe.push_back((float)std::cos(twoPi * k / size));
+        splitIm.push_back((float)-std::sin(twoPi * k / size));
+    }
+}
+
+void SimdRealFFT::performFrequencyOnlyForwardTransform(float* data) const
+{
+    const auto M = halfSize;
+    
+    //pack even samples as real and odd samples as imaginary into the upper half of the buffer,
+    //the consumed input in the lower half then serves as the stockham scratch
+    float* upperRe = data + size;
+    float* upperIm = data + size + M;
+    
+    for (int n = 0; n < M; ++n)
+    {
+        upperRe[n] = data[2 * n];
+        upperIm[n] = data[2 * n + 1];
+    }
+    
+    float* zr = nullptr;
+    float* zi = nullptr;
+    runStages(upperRe, upperIm, data, data + M, M,
+              twiddleRe.data(), twiddleIm.data(),
+              narrowTwiddleRe.data(), narrowTwiddleIm.data(),
+              &zr, &zi);
+    
+    //split Z into the real spectrum: X[k] = E[k] + W^k O[k] and X[M-k] = conj(E[k] - W^k O[k]).
+    //bins k and M-k are read before either is written, so this is safe when Z sits in the lower half.
+    for (int k = 0; k <= M / 2; ++k)
+    {
+        const auto mk = (M - k) & (M - 1);
+        
+        const auto zkr = zr[k],  zki = zi[k];
+        const auto zmr = zr[mk], zmi = zi[mk];
+        
+        const auto er = 0.5f * (zkr + zmr);
+        const auto ei = 0.5f * (zki - zmi);
+        const auto or_ = 0.5f * (zki + zmi);
+        const auto oi = -0.5f * (zkr - zmr);
+        
+        const auto ar = splitRe[k] * or_ - splitIm[k] * oi;
+        const auto ai = splitRe[k] * oi + splitIm[k] * or_;
+        
+        const auto lower = std::sqrt((er + ar) * (er + ar) + (ei + ai) * (ei + ai));
+        const auto upper = std::sqrt((er - ar) * (er - ar) + (ei - ai) * (ei - ai));
+        
+        data[k] = lower;
+        
+        if (k != M - k)
+            data[M - k] = upper;
+    }
+    
+    //mirror the negative frequencies like juce::dsp::FFT does
+    for (int k = 1; k < M; ++k)
+        data[size - k] = data[k];
+}
@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    SimdRealFFT.h
+    Self-contained SIMD real-input FFT for the analyzer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FFTEngine.h"
+#include <vector>
+
+/*
+ real fft of size N as a complex Stockham radix-2 fft of size N/2 over the even/odd
+ packed input, followed by the usual split into the N/2 + 1 real spectrum bins.
+ the butterflies run on SSE2, AVX2 + FMA or NEON, picked at runtime from the cpu features
+ (or forced through the constructor), with a scalar build of the same kernel as a fallback.
+ all scratch space lives in the caller's 2N float buffer.
+ */
+class SimdRealFFT : public FFTEngine
+{
+public:
+    enum class InstructionSet
+    {
+        scalar,
+        sse2,
+        avx2,
+        neon
+    };
+    
+    SimdRealFFT(int order, InstructionSet instructionSet = getBestInstructionSet());
+    
+    static InstructionSet getBestInstructionSet();
+    static bool isSupported(InstructionSet instructionSet);
+    
+    int getSize() const override {return size;}
+    void performFrequencyOnlyForwardTransform(float* data) const override;
+    const char* getName() const override;
+    size_t getMemoryUsage() const override;
+    
+    using StagesFunction = void (*)(float* re, float* im,
+                                    float* scratchRe, float* scratchIm,
+                                    int numPoints,
+                                    const float* twiddleRe, const float* twiddleIm,
+                                    const float* narrowTwiddleRe, const float* narrowTwiddleIm,
+                                    float** resultRe, float** resultIm);
+    
+private:
+    int size, halfSize;
+    InstructionSet instructionSet;
+    StagesFunction runStages;
+    
+    //complex stage twiddles, one run of n/2 per stage of length n, concatenated
+    std::vector<float> twiddleRe, twiddleIm;
+    
+    //the same twiddles repeated once per element for the stages narrower than a vector
+    std::vector<float> narrowTwiddleRe, narrowTwiddleIm;
+    
+    //e^(-2 pi i k / N) for the real spectrum split, k = 0..N/4
+    std::vector<float> splitRe, splitIm;
+    
+    JUCE_DECLARE_NON_COPYABLE(SimdRealFFT)
+};
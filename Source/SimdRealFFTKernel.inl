@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    SimdRealFFTKernel.inl
+    Stockham radix-2 stages, included once per instruction set by SimdRealFFT.cpp.
+
+    The including namespace provides Vec, vecWidth, load, store, broadcast,
+    add, sub, mul, mulAdd (acc + a * b), mulSub (acc - a * b) and storeInterleaved. Including it inside a target pragma region is what lets
+    the AVX2 build coexist with the baseline one in the same binary.
+
+  ==============================================================================
+*/
+
+static void runStages(float* re, float* im,
+                      float* scratchRe, float* scratchIm,
+                      int numPoints,
+                      const float* twiddleRe, const float* twiddleIm,
+                      const float* narrowTwiddleRe, const float* narrowTwiddleIm,
+                      float** resultRe, float** resultIm)
+{
+    float* xr = re;
+    float* xi = im;
+    float* yr = scratchRe;
+    float* yi = scratchIm;
+    
+    for (int n = numPoints, s = 1; n >= 2; n /= 2, s *= 2)
+    {
+        const int m = n / 2;
+        
+        if (s < vecWidth && m * s >= vecWidth)
+        {
+            //the first stages are narrower than a vector: run W consecutive (p, q) pairs at once
+            //against twiddles pre-expanded to one per element, then interleave sums and differences
+            //back in chunks of s
+            for (int j = 0; j < m * s; j += vecWidth)
+            {
+                const auto ar = load(xr + j),         ai = load(xi + j);
+                const auto br = load(xr + j + m * s), bi = load(xi + j + m * s);
+                const auto wr = load(narrowTwiddleRe + j);
+                const auto wi = load(narrowTwiddleIm + j);
+                
+                const auto dr = sub(ar, br), di = sub(ai, bi);
+                
+                storeInterleaved(yr + 2 * j, add(ar, br), mulSub(mul(dr, wr), di, wi), s);
+                storeInterleaved(yi + 2 * j, add(ai, bi), mulAdd(mul(dr, wi), di, wr), s);
+            }
+        }
+        else if (s < vecWidth)
+        {
+            //only reached by tiny transforms
+            for (int p = 0; p < m; ++p)
+            {
+                const auto wr = twiddleRe[p];
+                const auto wi = twiddleIm[p];
+                
+                for (int q = 0; q < s; ++q)
+                {
+                    const auto ar = xr[q + s * p],       ai = xi[q + s * p];
+                    const auto br = xr[q + s * (p + m)], bi = xi[q + s * (p + m)];
+                    
+                    yr[q + s * 2 * p] = ar + br;
+                    yi[q + s * 2 * p] = ai + bi;
+                    
+                    const auto dr = ar - br, di = ai - bi;
+                    yr[q + s * (2 * p + 1)] = dr * wr - di * wi;
+                    yi[q + s * (2 * p + 1)] = dr * wi + di * wr;
+                }
+            }
+        }
+        else
+        {
+            for (int p = 0; p < m; ++p)
+            {
+                const auto wr = broadcast(twiddleRe[p]);
+                const auto wi = broadcast(twiddleIm[p]);
+                
+                const float* aRe = xr + s * p;
+                const float* aIm = xi + s * p;
+                const float* bRe = xr + s * (p + m);
+                const float* bIm = xi + s * (p + m);
+                float* sumRe = yr + s * 2 * p;
+                float* sumIm = yi + s * 2 * p;
+                float* diffRe = yr + s * (2 * p + 1);
+                float* diffIm = yi + s * (2 * p + 1);
+                
+                for (int q = 0; q < s; q += vecWidth)
+                {
+                    const auto ar = load(aRe + q), ai = load(aIm + q);
+                    const auto br = load(bRe + q), bi = load(bIm + q);
+                    
+                    store(sumRe + q, add(ar, br));
+                    store(sumIm + q, add(ai, bi));
+                    
+                    const auto dr = sub(ar, br), di = sub(ai, bi);
+                    store(diffRe + q, mulSub(mul(dr, wr), di, wi));
+                    store(diffIm + q, mulAdd(mul(dr, wi), di, wr));
+                }
+            }
+        }
+        
+        twiddleRe += m;
+        twiddleIm += m;
+        
+        if (s < narrowStageLimit)
+        {
+            narrowTwiddleRe += m * s;
+            narrowTwiddleIm += m * s;
+        }
+        
+        std::swap(xr, yr);
+        std::swap(xi, yi);
+    }
+    
+    *resultRe = xr;
+    *resultIm = xi;
+}
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    StandaloneApp.cpp
+    The standalone app: juce's usual plugin window, or with --render a headless
+    render of one file.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#if JucePlugin_Build_Standalone && JUCE_USE_CUSTOM_PLUGIN_STANDALONE_APP
+
+#include <juce_audio_plugin_client/Standalone/juce_StandaloneFilterWindow.h>
+#include <iostream>
+#include "FFTPlanCache.h"
+#include "StreamingRender.h"
+
+/*
+ the same as juce's own StandaloneFilterApp, unless it's started with
+     Thelassic --render=<input> --output=<file> [--state=<file>] [--block-size=<samples>]
+ in which case it renders the input through a fresh processor without opening a window, printing
+ progress as it goes, and quits. --state takes a .filterstate file saved from the standalone's
+ options menu.
+     Thelassic --benchmark-fft[=<order>]
+ times the analyzer's fft backends against each other at every analyzer size (or just 2^order)
+ and quits.
+ */
+class ThelassicStandaloneApp : public juce::JUCEApplication
+{
+public:
+    ThelassicStandaloneApp()
+    {
+        juce::PropertiesFile::Options options;
+        options.applicationName = getApplicationName();
+        options.filenameSuffix = ".settings";
+        options.osxLibrarySubFolder = "Application Support";
+       #if JUCE_LINUX || JUCE_BSD
+        options.folderName = "~/.config";
+       #endif
+
+        appProperties.setStorageParameters(options);
+    }
+
+    const juce::String getApplicationName() override {return JucePlugin_Name;}
+    const juce::String getApplicationVersion() override {return JucePlugin_VersionString;}
+    bool moreThanOneInstanceAllowed() override {return true;}
+    void anotherInstanceStarted(const juce::String&) override {}
+
+    void initialise(const juce::String& commandLine) override
+    {
+        const juce::ArgumentList arguments(getApplicationName(), commandLine);
+
+        if (arguments.containsOption("--render"))
+        {
+            setApplicationReturnValue(renderFromCommandLine(arguments) ? 0 : 1);
+            quit();
+            return;
+        }
+
+        if (arguments.containsOption("--benchmark-fft"))
+        {
+            benchmarkFFTFromCommandLine(arguments);
+            quit();
+            return;
+        }
+
+        mainWindow = std::make_unique<juce::StandaloneFilterWindow>(getApplicationName(),
+                                                                    juce::LookAndFeel::getDefaultLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId),
+                                                                    appProperties.getUserSettings(),
+                                                                    false);
+        mainWindow->setVisible(true);
+    }
+
+    void shutdown() override
+    {
+        if (mainWindow != nullptr)
+            mainWindow->pluginHolder->savePluginState();
+
+        mainWindow = nullptr;
+        appProperties.saveIfNeeded();
+    }
+
+    void systemRequestedQuit() override
+    {
+        if (mainWindow != nullptr)
+            mainWindow->pluginHolder->savePluginState();
+
+        if (juce::ModalComponentManager::getInstance()->cancelAllModalComponents())
+        {
+            juce::Timer::callAfterDelay(100, []
+            {
+                if (auto* app = juce::JUCEApplicationBase::getInstance())
+                    app->systemRequestedQuit();
+            });
+        }
+        else
+        {
+            quit();
+        }
+    }
+
+private:
+    void benchmarkFFTFromCommandLine(const juce::ArgumentList& arguments)
+    {
+        auto benchmark = [](int order)
+        {
+            constexpr int numIterations = 2000;
+            std::cout << "2^" << order << " points: " << benchmarkFFTEngines(order, numIterations).toString() << std::endl;
+        };
+
+        const auto order = arguments.getValueForOption("--benchmark-fft").getIntValue();
+
+        if (order > 0)
+        {
+            benchmark(juce::jlimit(4, 16, order));
+            return;
+        }
+
+        for (auto analyzerOrder : {FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192})
+            benchmark(analyzerOrder);
+    }
+
+    bool renderFromCommandLine(const juce::ArgumentList& arguments)
+    {
+        auto getFile = [&arguments](const char* option)
+        {
+            const auto path = arguments.getValueForOption(option);
+            return path.isEmpty() ? juce::File() : juce::File::getCurrentWorkingDirectory().getChildFile(path.unquoted());
+        };
+
+        StreamingRender::Options options;
+        options.input = getFile("--render");
+        options.output = getFile("--output");
+
+        if (options.input == juce::File() || options.output == juce::File())
+        {
+            std::cerr << "usage: " << getApplicationName() << " --render=<input> --output=<file> [--state=<file>] [--block-size=<samples>]" << std::endl;
+            return false;
+        }
+
+        if (arguments.containsOption("--state") && ! getFile("--state").loadFileAsData(options.state))
+        {
+            std::cerr << "couldn't read " << arguments.getValueForOption("--state") << std::endl;
+            return false;
+        }
+
+        if (arguments.containsOption("--block-size"))
+            options.blockSize = arguments.getValueForOption("--block-size").getIntValue();
+
+        StreamingRender streamingRender;
+        const auto result = streamingRender.render(options, [](const StreamingRender::Progress& progress)
+        {
+            std::cout << progress.toString() << std::endl;
+        });
+
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    juce::ApplicationProperties appProperties;
+    std::unique_ptr<juce::StandaloneFilterWindow> mainWindow;
+};
+
+juce::JUCEApplicationBase* juce_CreateApplication()
+{
+    return new ThelassicStandaloneApp();
+}
+
+#endif
@@ -0,0 +1,426 @@
+/*
+  ==============================================================================
+
+    StreamingRender.cpp
+    Renders one long file through the processor with reading, processing and
+    writing overlapped on their own threads.
+
+  ==============================================================================
+*/
+
+#include "StreamingRender.h"
+
+namespace
+{
+    //how long a waiting stage sleeps before checking whether the render has failed
+    constexpr int waitTimeoutMs = 100;
+
+    juce::String formatDuration(double seconds)
+    {
+        const auto total = juce::jmax((juce::int64)0, (juce::int64)seconds);
+
+        return juce::String(total / 3600) + ":"
+             + juce::String((total / 60) % 60).paddedLeft('0', 2) + ":"
+             + juce::String(total % 60).paddedLeft('0', 2);
+    }
+}
+
+double StreamingRender::Progress::getRealtimeFactor() const
+{
+    if (elapsedSeconds <= 0.0 || sampleRate <= 0.0)
+        return 0.0;
+
+    return (double)samplesWritten / sampleRate / elapsedSeconds;
+}
+
+double StreamingRender::Progress::getInputMegabytesPerSecond() const
+{
+    if (elapsedSeconds <= 0.0)
+        return 0.0;
+
+    return (double)inputBytes * getFraction() / elapsedSeconds / (1024.0 * 1024.0);
+}
+
+juce::String StreamingRender::Progress::toString() const
+{
+    const auto fraction = getFraction();
+
+    juce::String str;
+    str << juce::String(fraction * 100.0, 1) << "% ("
+        << formatDuration((double)samplesWritten / sampleRate) << " of " << formatDuration((double)totalSamples / sampleRate) << "), "
+        << juce::String(getRealtimeFactor(), 1) << "x realtime, "
+        << juce::String(getInputMegabytesPerSecond(), 1) << " MB/s read, ";
+
+    if (fraction > 0.0 && fraction < 1.0)
+        str << formatDuration(elapsedSeconds * (1.0 - fraction) / fraction) << " left, ";
+    else
+        str << formatDuration(elapsedSeconds) << " taken, ";
+
+    //a stage that waits a lot is waiting on a slower one
+    str << "waits: reader " << (int)readerWaits << ", processor " << (int)processorWaits << ", writer " << (int)writerWaits;
+    return str;
+}
+
+//==============================================================================
+juce::Result StreamingRender::render(const Options& options, ProgressCallback progressCallback, double reportIntervalSeconds)
+{
+    failed.store(false);
+    error.clear();
+    samplesWritten.store(0);
+    readerWaits.store(0);
+    processorWaits.store(0);
+    writerWaits.store(0);
+
+    if (formatManager.getNumKnownFormats() == 0)
+        formatManager.registerBasicFormats();
+
+    if (auto result = openInput(options.input); result.failed())
+        return result;
+
+    if (auto result = openOutput(options); result.failed())
+        return result;
+
+    //anything failing from here on would leave a file with just a header in it
+    auto abandon = [&](const juce::Result& result)
+    {
+        writer.reset();
+        options.output.deleteFile();
+        return result;
+    };
+
+    blockSize = juce::jlimit(64, 65536, options.blockSize);
+    const auto sampleRate = reader->sampleRate;
+
+    processor = std::make_unique<ThelassicAudioProcessor>();
+
+    if (options.state.getSize() > 0)
+        processor->setStateInformation(options.state.getData(), (int)options.state.getSize());
+
+    //nobody's looking at the analyzer
+    processor->setLeanMode(true);
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+
+    if (! processor->setBusesLayout(layout))
+        return abandon(juce::Result::fail("Thelassic can't process " + juce::String(numChannels) + " channels"));
+
+    //offline, so wide files get the channel workers
+    processor->setNonRealtime(true);
+    processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor->prepareToPlay(sampleRate, blockSize);
+
+    //linear phase is silent until its impulse has loaded, which only happens as it processes.
+    //so run silence through it first, which leaves the filters holding nothing but zeros
+    {
+        constexpr double linearPhaseTimeoutMs = 10000.0;
+        const auto waitStartMs = juce::Time::getMillisecondCounterHiRes();
+        juce::AudioBuffer<float> silence(numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        while (! processor->isLinearPhaseReady())
+        {
+            if (juce::Time::getMillisecondCounterHiRes() - waitStartMs > linearPhaseTimeoutMs)
+                return abandon(juce::Result::fail("the linear phase impulse never loaded"));
+
+            silence.clear();
+            processor->processBlock(silence, midi);
+            juce::Thread::sleep(1);
+        }
+    }
+
+    latency = processor->getLatencySamples();
+
+    const auto queueBlocks = juce::jlimit(2, maxQueueBlocks, options.queueBlocks);
+
+    for (auto* queue : {&readQueue, &writeQueue})
+    {
+        queue->setNumSlots(queueBlocks);
+        queue->prepare(numChannels, blockSize);
+    }
+
+    Stage readerStage("Thelassic render reader", [this] {readAll();});
+    Stage processorStage("Thelassic render processor", [this] {processAll();});
+    Stage writerStage("Thelassic render writer", [this] {writeAll();});
+
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    auto report = [&]
+    {
+        if (progressCallback == nullptr)
+            return;
+
+        Progress progress;
+        progress.samplesWritten = samplesWritten.load();
+        progress.totalSamples = lengthInSamples;
+        progress.sampleRate = sampleRate;
+        progress.elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+        progress.inputBytes = options.input.getSize();
+        progress.readerWaits = readerWaits.load();
+        progress.processorWaits = processorWaits.load();
+        progress.writerWaits = writerWaits.load();
+        progressCallback(progress);
+    };
+
+    readerStage.startThread();
+    processorStage.startThread();
+    writerStage.startThread();
+
+    //the writer is the last to finish, and every stage gives up once one has failed
+    const auto reportIntervalMs = juce::jmax(1, juce::roundToInt(reportIntervalSeconds * 1000.0));
+
+    while (! writerStage.waitForThreadToExit(reportIntervalMs))
+        report();
+
+    readerStage.waitForThreadToExit(-1);
+    processorStage.waitForThreadToExit(-1);
+
+    processor->releaseResources();
+    processor.reset();
+
+    //finishes the header, so it has to go before the file can be used or removed
+    writer.reset();
+    reader.reset();
+    mappedReader = nullptr;
+
+    readQueue.release();
+    writeQueue.release();
+
+    if (failed.load())
+    {
+        const juce::ScopedLock sl(errorLock);
+        return abandon(juce::Result::fail(error));
+    }
+
+    report();
+    return juce::Result::ok();
+}
+
+juce::Result StreamingRender::openInput(const juce::File& file)
+{
+    reader.reset();
+    mappedReader = nullptr;
+
+    if (! file.existsAsFile())
+        return juce::Result::fail(file.getFullPathName() + " doesn't exist");
+
+    if (auto* format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+    {
+        if (auto* mapped = format->createMemoryMappedReader(file))
+        {
+            reader.reset(mapped);
+            mappedReader = mapped;
+        }
+    }
+
+    if (reader == nullptr)
+        reader.reset(formatManager.createReaderFor(file));
+
+    if (reader == nullptr)
+        return juce::Result::fail("couldn't read " + file.getFullPathName() + " as audio");
+
+    numChannels = (int)reader->numChannels;
+    lengthInSamples = reader->lengthInSamples;
+
+    if (numChannels < 1 || reader->sampleRate <= 0.0)
+        return juce::Result::fail(file.getFullPathName() + " has no audio in it");
+
+    return juce::Result::ok();
+}
+
+juce::Result StreamingRender::openOutput(const Options& options)
+{
+    writer.reset();
+
+    const auto& file = options.output;
+
+    if (file == options.input)
+        return juce::Result::fail("the output can't be the input");
+
+    auto* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+
+    if (format == nullptr)
+        return juce::Result::fail("there's no format to write " + file.getFileName() + " as");
+
+    const auto bitDepths = format->getPossibleBitDepths();
+    auto bitsPerSample = options.bitsPerSample > 0 ? options.bitsPerSample : (int)reader->bitsPerSample;
+
+    if (! bitDepths.contains(bitsPerSample) && ! bitDepths.isEmpty())
+        bitsPerSample = bitDepths.getLast();
+
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (! stream->openedOk())
+        return juce::Result::fail("couldn't open " + file.getFullPathName() + " for writing");
+
+    stream->setPosition(0);
+    stream->truncate();
+
+    writer.reset(format->createWriterFor(stream.get(), reader->sampleRate, (unsigned int)numChannels,
+                                         bitsPerSample, reader->metadataValues, 0));
+
+    if (writer == nullptr)
+        return juce::Result::fail("couldn't write " + juce::String(numChannels) + " channels of "
+                                  + juce::String(bitsPerSample) + " bit audio to " + file.getFileName());
+
+    //the writer owns it now
+    stream.release();
+    return juce::Result::ok();
+}
+
+//==============================================================================
+void StreamingRender::readAll()
+{
+    for (juce::int64 position = 0; position < lengthInSamples; position += blockSize)
+    {
+        auto* buffer = waitToWrite(readQueue, readQueueFreed, readerWaits);
+
+        if (buffer == nullptr)
+            return;
+
+        const auto numSamples = (int)juce::jmin((juce::int64)blockSize, lengthInSamples - position);
+        buffer->setSize(numChannels, numSamples, false, false, true);
+
+        if (! readBlock(*buffer, position, numSamples))
+        {
+            fail("couldn't read the input at sample " + juce::String(position));
+            return;
+        }
+
+        readQueue.commitWrite();
+        readQueueFilled.signal();
+    }
+}
+
+void StreamingRender::processAll()
+{
+    juce::MidiBuffer midi;
+
+    //past the end of the input, silence pushes the last of the latency out
+    const auto totalSamples = lengthInSamples + latency;
+
+    for (juce::int64 position = 0; position < totalSamples; )
+    {
+        auto* output = waitToWrite(writeQueue, writeQueueFreed, processorWaits);
+
+        if (output == nullptr)
+            return;
+
+        if (position < lengthInSamples)
+        {
+            auto* input = waitToRead(readQueue, readQueueFilled, processorWaits);
+
+            if (input == nullptr)
+                return;
+
+            //swapped rather than copied, the read queue gets the spare buffer back
+            std::swap(*input, *output);
+            readQueue.releaseRead();
+            readQueueFreed.signal();
+        }
+        else
+        {
+            output->setSize(numChannels, (int)juce::jmin((juce::int64)blockSize, totalSamples - position), false, false, true);
+            output->clear();
+        }
+
+        processor->processBlock(*output, midi);
+        midi.clear();
+
+        position += output->getNumSamples();
+        writeQueue.commitWrite();
+        writeQueueFilled.signal();
+    }
+}
+
+void StreamingRender::writeAll()
+{
+    const auto totalSamples = lengthInSamples + latency;
+
+    for (juce::int64 position = 0; position < totalSamples; )
+    {
+        auto* buffer = waitToRead(writeQueue, writeQueueFilled, writerWaits);
+
+        if (buffer == nullptr)
+            return;
+
+        //the first 'latency' samples are from before the input started
+        const auto numSamples = buffer->getNumSamples();
+        const auto skip = (int)juce::jlimit((juce::int64)0, (juce::int64)numSamples, (juce::int64)latency - position);
+        position += numSamples;
+
+        if (numSamples > skip && ! writer->writeFromAudioSampleBuffer(*buffer, skip, numSamples - skip))
+        {
+            fail("couldn't write the output, is the disk full?");
+            return;
+        }
+
+        samplesWritten.fetch_add(numSamples - skip);
+        writeQueue.releaseRead();
+        writeQueueFreed.signal();
+    }
+}
+
+bool StreamingRender::readBlock(juce::AudioBuffer<float>& buffer, juce::int64 start, int numSamples)
+{
+    if (mappedReader != nullptr)
+    {
+        const juce::Range<juce::int64> wanted(start, start + numSamples);
+
+        //only a window is mapped at a time, so the address space used doesn't grow with the file either
+        if (! mappedReader->getMappedSection().contains(wanted))
+        {
+            const auto end = juce::jmin(lengthInSamples, start + (juce::int64)blockSize * mapWindowBlocks);
+
+            if (! mappedReader->mapSectionOfFile({start, end}))
+                return false;
+        }
+    }
+
+    reader->read(&buffer, 0, numSamples, start, true, true);
+    return true;
+}
+
+juce::AudioBuffer<float>* StreamingRender::waitToWrite(Queue& queue, juce::WaitableEvent& slotFreed, std::atomic<juce::uint32>& waits)
+{
+    while (! failed.load())
+    {
+        if (auto* slot = queue.acquireWrite())
+            return slot;
+
+        waits.fetch_add(1);
+        slotFreed.wait(waitTimeoutMs);
+    }
+
+    return nullptr;
+}
+
+juce::AudioBuffer<float>* StreamingRender::waitToRead(Queue& queue, juce::WaitableEvent& slotFilled, std::atomic<juce::uint32>& waits)
+{
+    while (! failed.load())
+    {
+        if (auto* slot = queue.acquireRead())
+            return slot;
+
+        waits.fetch_add(1);
+        slotFilled.wait(waitTimeoutMs);
+    }
+
+    return nullptr;
+}
+
+void StreamingRender::fail(const juce::String& message)
+{
+    {
+        const juce::ScopedLock sl(errorLock);
+
+        if (error.isEmpty())
+            error = message;
+    }
+
+    failed.store(true);
+
+    for (auto* event : {&readQueueFilled, &readQueueFreed, &writeQueueFilled, &writeQueueFreed})
+        event->signal();
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    StreamingRender.h
+    Renders one long file through the processor with reading, processing and
+    writing overlapped on their own threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include "PluginProcessor.h"
+
+/*
+ pushes a whole file through a ThelassicAudioProcessor of its own, for archives too long to
+ go through a host. a reader thread fills blocks, a processing thread runs them through the
+ processor and a writer thread writes them out, with a Fifo of preallocated blocks between
+ each, so memory stays at 2 * queueBlocks blocks however long the file is. whichever stage
+ is slowest, normally reading or writing, sets the pace and the others wait on it.
+ wav and aiff inputs are memory mapped a window at a time, anything else is read in blocks.
+ the output is latency compensated and exactly as long as the input. with linear phase on,
+ the stages wait for its impulse to load first, and the render fails if it never does.
+ */
+class StreamingRender
+{
+public:
+    struct Options
+    {
+        juce::File input, output;
+
+        //from getStateInformation(), e.g. a .filterstate file saved from the standalone. empty keeps the defaults
+        juce::MemoryBlock state;
+
+        int blockSize = 4096;
+        int queueBlocks = 16;
+
+        //0 keeps the input's, if the output format can do it
+        int bitsPerSample = 0;
+    };
+
+    struct Progress
+    {
+        juce::int64 samplesWritten = 0, totalSamples = 0;
+        double sampleRate = 0.0, elapsedSeconds = 0.0;
+        juce::int64 inputBytes = 0;
+
+        //times a stage found its queue full (reader, processor) or empty (processor, writer)
+        juce::uint32 readerWaits = 0, processorWaits = 0, writerWaits = 0;
+
+        double getFraction() const {return totalSamples > 0 ? (double)samplesWritten / (double)totalSamples : 1.0;}
+        double getRealtimeFactor() const;
+        double getInputMegabytesPerSecond() const;
+        juce::String toString() const;
+    };
+
+    //called on the thread that called render(), every 'reportInterval' and once at the end
+    using ProgressCallback = std::function<void(const Progress&)>;
+
+    StreamingRender() = default;
+
+    //blocks until the whole file is written or something fails
+    juce::Result render(const Options& options, ProgressCallback progressCallback = {}, double reportIntervalSeconds = 1.0);
+
+    static constexpr int maxQueueBlocks = 64;
+
+private:
+    using Queue = Fifo<juce::AudioBuffer<float>, maxQueueBlocks>;
+
+    struct Stage : juce::Thread
+    {
+        Stage(const juce::String& name, std::function<void()> body) : juce::Thread(name), work(std::move(body)) {}
+        void run() override {work();}
+
+        std::function<void()> work;
+    };
+
+    juce::Result openInput(const juce::File& file);
+    juce::Result openOutput(const Options& options);
+
+    void readAll();
+    void processAll();
+    void writeAll();
+
+    //reads [start, start + numSamples) into 'buffer', mapping the next window of the file first if need be
+    bool readBlock(juce::AudioBuffer<float>& buffer, juce::int64 start, int numSamples);
+
+    //waits for a slot of 'queue', returning nullptr once the render has failed
+    juce::AudioBuffer<float>* waitToWrite(Queue& queue, juce::WaitableEvent& slotFreed, std::atomic<juce::uint32>& waits);
+    juce::AudioBuffer<float>* waitToRead(Queue& queue, juce::WaitableEvent& slotFilled, std::atomic<juce::uint32>& waits);
+
+    void fail(const juce::String& message);
+
+    juce::AudioFormatManager formatManager;
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::MemoryMappedAudioFormatReader* mappedReader = nullptr;   //'reader', when the format can be mapped
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    std::unique_ptr<ThelassicAudioProcessor> processor;
+
+    //how much of the file is mapped at once, in blocks
+    static constexpr int mapWindowBlocks = 256;
+
+    int numChannels = 0, blockSize = 0, latency = 0;
+    juce::int64 lengthInSamples = 0;
+
+    //reader to processor, and processor to writer
+    Queue readQueue, writeQueue;
+    juce::WaitableEvent readQueueFilled, readQueueFreed, writeQueueFilled, writeQueueFreed;
+
+    std::atomic<juce::int64> samplesWritten {0};
+    std::atomic<juce::uint32> readerWaits {0}, processorWaits {0}, writerWaits {0};
+
+    std::atomic<bool> failed {false};
+    juce::CriticalSection errorLock;
+    juce::String error;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamingRender)
+};
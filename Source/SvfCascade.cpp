@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    SvfCascade.cpp
+    The bands as trapezoidal state variable filters, for heavy modulation.
+
+  ==============================================================================
+*/
+
+#include "SvfCascade.h"
+
+void designSvfBand(const BandSettings& band, double sampleRate, SvfBand& svf)
+{
+    svf.numStages = 0;
+
+    if (band.bypassed)
+        return;
+
+    //the same limits and prewarp as designBand(), which is what keeps the responses identical
+    const auto freq = juce::jmin((double)band.freq, sampleRate * 0.49);
+    const auto g = std::tan(juce::MathConstants<double>::pi * freq / sampleRate);
+    const auto k = 1.0 / (double)band.q;
+
+    //shelves and bells are parameterised by the square root of their gain
+    const auto a = std::sqrt(juce::Decibels::decibelsToGain((double)band.gain));
+
+    svf.numStages = 1;
+    auto& stage = svf.stages[0];
+    stage.g = g;
+
+    if (band.isCut())
+    {
+        //the same analog sections the biquads are transformed from, each tuned to its own pole pair
+        AnalogSection analog[maxSectionsPerBand];
+        svf.numStages = designAnalogCut(band, analog);
+
+        for (int i = 0; i < svf.numStages; ++i)
+        {
+            auto& section = analog[i];
+            svf.stages[(size_t)i] = {section.w0 * g, section.k, section.n2, section.n1 - section.k * section.n2, section.n0 - section.n2};
+        }
+
+        return;
+    }
+
+    switch (band.type)
+    {
+        case BandType::bell:
+            stage.k = k / a;
+            stage.m0 = 1.0;
+            stage.m1 = stage.k * (a * a - 1.0);
+            stage.m2 = 0.0;
+            break;
+        case BandType::lowShelf:
+            stage.g = g / std::sqrt(a);
+            stage.k = k;
+            stage.m0 = 1.0;
+            stage.m1 = k * (a - 1.0);
+            stage.m2 = a * a - 1.0;
+            break;
+        case BandType::highShelf:
+            stage.g = g * std::sqrt(a);
+            stage.k = k;
+            stage.m0 = a * a;
+            stage.m1 = k * (1.0 - a) * a;
+            stage.m2 = 1.0 - a * a;
+            break;
+        case BandType::notch:
+            stage.k = k;
+            stage.m0 = 1.0;
+            stage.m1 = -k;
+            stage.m2 = 0.0;
+            break;
+        default:
+            jassertfalse;
+            break;
+    }
+}
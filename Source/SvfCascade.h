@@ -0,0 +1,416 @@
+/*
+  ==============================================================================
+
+    SvfCascade.h
+    The bands as trapezoidal state variable filters, for heavy modulation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterCascade.h"
+
+/*
+ one band as up to maxSectionsPerBand trapezoidal svf stages (andrew simper's formulation).
+ every stage has its own prewarped cutoff g, damping k and mix m0, m1, m2 of the input, band
+ pass and low pass outputs. a butterworth cut's stages all share one g, chebyshev and elliptic
+ cuts have their pole pairs spread around the cutoff.
+ the trapezoidal svf is the bilinear transform of the same analog prototype the biquad designs
+ use, prewarped the same way, so for the same settings it has exactly designBand()'s response.
+ */
+struct SvfBand
+{
+    struct Stage
+    {
+        double g = 0.0, k = 1.0, m0 = 1.0, m1 = 0.0, m2 = 0.0;
+    };
+
+    std::array<Stage, maxSectionsPerBand> stages;
+    int numStages = 0;
+};
+
+//a bypassed band has no stages
+void designSvfBand(const BandSettings& band, double sampleRate, SvfBand& svf);
+
+/*
+ every band of a ChainSettings as svf stages, in the same order FilterCascade runs them.
+
+ a biquad's coefficients can only jump once a block, and jumping them fast can blow it up.
+ the svf stays well behaved however fast its coefficients move and moving them is cheap, so
+ here every change is ramped sample by sample across the next block: g, k and the mixes are
+ interpolated and only a1 = 1 / (1 + g (g + k)) is recomputed per stage, no trig per sample.
+ bypass ramps in and out the same way. bands only pay for the per sample work while moving.
+ the first two channels can have targets of their own, any channels past those run the first's.
+ while they're the same they're designed and interpolated once and every channel runs them together.
+ */
+template<typename SampleType>
+class SvfCascade
+{
+public:
+    void prepare(int numChannels)
+    {
+        channels.resize((size_t)numChannels);
+        reset();
+        snapToNextTargets();
+    }
+
+    void reset()
+    {
+        for (auto& channel : channels)
+        {
+            for (auto& band : channel)
+            {
+                for (auto& stage : band)
+                    stage = {};
+            }
+        }
+
+        //whatever was moving arrives
+        current = target;
+        idle = false;
+    }
+
+    //the first targets after prepare() are where the bands start, not somewhere they ramp to
+    void snapToNextTargets() {shouldSnap = true;}
+
+    //what the next block ramps every band to
+    void setTargets(const ChainSettings& chainSettings, double sampleRate)
+    {
+        setTargets(chainSettings, chainSettings, sampleRate);
+    }
+
+    //'first' for the first channel and any past the second, 'second' for the second
+    void setTargets(const ChainSettings& first, const ChainSettings& second, double sampleRate)
+    {
+        if (sampleRate <= 0.0)
+            return;
+
+        setLaneTargets(target[0], first, sampleRate);
+
+        const auto wereDifferent = lanesDiffer;
+        lanesDiffer = second != first;
+
+        if (lanesDiffer)
+            setLaneTargets(target[1], second, sampleRate);
+        else
+            target[1] = target[0];
+
+        //the second channel goes back to running the first's stages, anything past those has to be at rest
+        if (wereDifferent && ! lanesDiffer)
+        {
+            for (size_t band = 0; band < (size_t)numBands; ++band)
+            {
+                if (channels.size() > 1)
+                {
+                    for (auto stage = (size_t)current[0][band].numStages; stage < (size_t)maxSectionsPerBand; ++stage)
+                        channels[1][band][stage] = {};
+                }
+
+                current[1][band] = current[0][band];
+            }
+        }
+
+        if (shouldSnap)
+        {
+            current = target;
+            shouldSnap = false;
+        }
+    }
+
+    /*
+     where each band's coefficients are heading is settled before any channel runs, so
+     'forEachGroup' can go over the channels however it likes, see FilterCascade::process().
+     */
+    template<typename ForEachGroup = SerialChannels>
+    void process(const juce::dsp::AudioBlock<SampleType>& block, bool inputIsSilent = false,
+                 ForEachGroup&& forEachGroup = {})
+    {
+        if (! inputIsSilent)
+            idle = false;
+        else if (idle)
+            return;
+
+        const auto numChannels = juce::jmin(block.getNumChannels(), channels.size());
+        const auto splitLanes = lanesDiffer && numChannels > 1;
+        const auto numLanes = splitLanes ? (size_t)2 : (size_t)1;
+
+        for (size_t band = 0; band < (size_t)numBands; ++band)
+        {
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                bandRuns[lane][band] = startBand(lane, band);
+        }
+
+        forEachGroup(numChannels, [this, &block, splitLanes](size_t first, size_t count)
+        {
+            const auto last = first + count;
+
+            for (size_t band = 0; band < (size_t)numBands; ++band)
+            {
+                if (splitLanes && first < 2)
+                {
+                    processBand(0, band, block, first, 1);
+                    processBand(1, band, block, 1, juce::jmin(last, (size_t)2));
+                    processBand(0, band, block, 2, last);
+                }
+                else
+                {
+                    processBand(0, band, block, first, last);
+                }
+            }
+        });
+
+        for (size_t band = 0; band < (size_t)numBands; ++band)
+        {
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                current[lane][band] = target[lane][band];
+
+            if (! splitLanes)
+                current[1][band] = current[0][band];
+        }
+
+        if (inputIsSilent && hasRungOut())
+        {
+            reset();
+            idle = true;
+        }
+    }
+
+    bool isIdle() const {return idle;}
+
+private:
+    struct BandCoefficients
+    {
+        SampleType wet = 0;
+        std::array<SampleType, maxSectionsPerBand> g {}, k {}, m0 {}, m1 {}, m2 {};
+        int numStages = 0;
+
+        bool operator==(const BandCoefficients& other) const
+        {
+            return wet == other.wet && numStages == other.numStages
+                && g == other.g && k == other.k && m0 == other.m0 && m1 == other.m1 && m2 == other.m2;
+        }
+    };
+
+    struct StageState
+    {
+        SampleType ic1 = 0, ic2 = 0;
+    };
+
+    using BandState = std::array<StageState, maxSectionsPerBand>;
+    using ChannelState = std::array<BandState, numBands>;
+    using LaneCoefficients = std::array<BandCoefficients, numBands>;
+
+    static void setLaneTargets(LaneCoefficients& lane, const ChainSettings& chainSettings, double sampleRate)
+    {
+        for (size_t band = 0; band < (size_t)numBands; ++band)
+        {
+            SvfBand svf;
+            designSvfBand(chainSettings.bands[band], sampleRate, svf);
+
+            auto& coefficients = lane[band];
+            coefficients.wet = svf.numStages > 0 ? SampleType(1) : SampleType(0);
+
+            //a bypassed band keeps its last curve and just fades out
+            if (svf.numStages == 0)
+                continue;
+
+            coefficients.numStages = svf.numStages;
+
+            for (size_t stage = 0; stage < (size_t)svf.numStages; ++stage)
+            {
+                coefficients.g[stage] = (SampleType)svf.stages[stage].g;
+                coefficients.k[stage] = (SampleType)svf.stages[stage].k;
+                coefficients.m0[stage] = (SampleType)svf.stages[stage].m0;
+                coefficients.m1[stage] = (SampleType)svf.stages[stage].m1;
+                coefficients.m2[stage] = (SampleType)svf.stages[stage].m2;
+            }
+        }
+    }
+
+    //brings 'lane's coefficients for 'band' up to date with a change of slope or bypass, false if it's bypassed and settled
+    bool startBand(size_t lane, size_t band)
+    {
+        auto& from = current[lane][band];
+        const auto& to = target[lane][band];
+
+        stagesChanged[lane][band] = false;
+
+        if (from == to && to.wet == SampleType(0))
+            return false;
+
+        //stages the new slope adds start from rest at their final coefficients, ones it drops are cleared
+        if (from.numStages != to.numStages)
+        {
+            for (auto stage = (size_t)from.numStages; stage < (size_t)to.numStages; ++stage)
+            {
+                from.g[stage] = to.g[stage];
+                from.k[stage] = to.k[stage];
+                from.m0[stage] = to.m0[stage];
+                from.m1[stage] = to.m1[stage];
+                from.m2[stage] = to.m2[stage];
+            }
+
+            from.numStages = to.numStages;
+            stagesChanged[lane][band] = true;
+        }
+
+        //a band fading in starts from its target curve, not from wherever it was bypassed
+        if (from.wet == SampleType(0))
+        {
+            const auto wet = from.wet;
+            from = to;
+            from.wet = wet;
+        }
+
+        return true;
+    }
+
+    //one band of channels [firstChannel, lastChannel), ramping 'lane' from its current coefficients to its target
+    void processBand(size_t lane, size_t band, const juce::dsp::AudioBlock<SampleType>& block,
+                     size_t firstChannel, size_t lastChannel)
+    {
+        if (! bandRuns[lane][band] || firstChannel >= lastChannel)
+            return;
+
+        const auto& from = current[lane][band];
+        const auto& to = target[lane][band];
+
+        if (stagesChanged[lane][band])
+        {
+            for (auto channel = firstChannel; channel < lastChannel; ++channel)
+            {
+                for (auto stage = (size_t)to.numStages; stage < (size_t)maxSectionsPerBand; ++stage)
+                    channels[channel][band][stage] = {};
+            }
+        }
+
+        const auto numSamples = block.getNumSamples();
+        const auto numStages = (size_t)to.numStages;
+
+        if (from == to)
+        {
+            //settled: coefficients are worked out once for the whole block
+            std::array<SampleType, maxSectionsPerBand> a1 {}, a2 {}, a3 {};
+
+            for (size_t stage = 0; stage < numStages; ++stage)
+            {
+                const auto g = to.g[stage];
+                a1[stage] = SampleType(1) / (SampleType(1) + g * (g + to.k[stage]));
+                a2[stage] = g * a1[stage];
+                a3[stage] = g * a2[stage];
+            }
+
+            for (auto channel = firstChannel; channel < lastChannel; ++channel)
+            {
+                auto* data = block.getChannelPointer(channel);
+                auto& state = channels[channel][band];
+
+                for (size_t stage = 0; stage < numStages; ++stage)
+                {
+                    auto ic1 = state[stage].ic1, ic2 = state[stage].ic2;
+                    const auto sa1 = a1[stage], sa2 = a2[stage], sa3 = a3[stage];
+                    const auto m0 = to.m0[stage], m1 = to.m1[stage], m2 = to.m2[stage];
+
+                    for (size_t i = 0; i < numSamples; ++i)
+                    {
+                        const auto v0 = data[i];
+                        const auto v3 = v0 - ic2;
+                        const auto v1 = sa1 * ic1 + sa2 * v3;
+                        const auto v2 = ic2 + sa2 * ic1 + sa3 * v3;
+                        ic1 = SampleType(2) * v1 - ic1;
+                        ic2 = SampleType(2) * v2 - ic2;
+                        data[i] = m0 * v0 + m1 * v1 + m2 * v2;
+                    }
+
+                    state[stage].ic1 = ic1;
+                    state[stage].ic2 = ic2;
+                }
+            }
+
+            return;
+        }
+
+        //moving: everything is interpolated towards the target, reaching it on the last sample
+        const auto step = SampleType(1) / SampleType(juce::jmax((size_t)1, numSamples));
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto t = SampleType(i + 1) * step;
+            auto lerp = [t](SampleType a, SampleType b) {return a + (b - a) * t;};
+
+            const auto wet = lerp(from.wet, to.wet);
+
+            std::array<SampleType, maxSectionsPerBand> a1 {}, a2 {}, a3 {}, m0 {}, m1 {}, m2 {};
+
+            for (size_t stage = 0; stage < numStages; ++stage)
+            {
+                const auto g = lerp(from.g[stage], to.g[stage]);
+                a1[stage] = SampleType(1) / (SampleType(1) + g * (g + lerp(from.k[stage], to.k[stage])));
+                a2[stage] = g * a1[stage];
+                a3[stage] = g * a2[stage];
+                m0[stage] = lerp(from.m0[stage], to.m0[stage]);
+                m1[stage] = lerp(from.m1[stage], to.m1[stage]);
+                m2[stage] = lerp(from.m2[stage], to.m2[stage]);
+            }
+
+            for (auto channel = firstChannel; channel < lastChannel; ++channel)
+            {
+                auto& sample = block.getChannelPointer(channel)[i];
+                auto& state = channels[channel][band];
+                const auto x = sample;
+                auto y = x;
+
+                for (size_t stage = 0; stage < numStages; ++stage)
+                {
+                    auto& s = state[stage];
+                    const auto v3 = y - s.ic2;
+                    const auto v1 = a1[stage] * s.ic1 + a2[stage] * v3;
+                    const auto v2 = s.ic2 + a2[stage] * s.ic1 + a3[stage] * v3;
+                    s.ic1 = SampleType(2) * v1 - s.ic1;
+                    s.ic2 = SampleType(2) * v2 - s.ic2;
+                    y = m0[stage] * y + m1[stage] * v1 + m2[stage] * v2;
+                }
+
+                sample = x + (y - x) * wet;
+            }
+        }
+
+        //fully faded out, so it starts from rest when it comes back
+        if (to.wet == SampleType(0))
+        {
+            for (auto channel = firstChannel; channel < lastChannel; ++channel)
+                channels[channel][band] = {};
+        }
+    }
+
+    bool hasRungOut() const
+    {
+        for (auto& channel : channels)
+        {
+            for (auto& band : channel)
+            {
+                for (auto& stage : band)
+                {
+                    if (std::abs(stage.ic1) >= silenceThreshold<SampleType>
+                     || std::abs(stage.ic2) >= silenceThreshold<SampleType>)
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    //per lane: the first channel's and any past the second, then the second's
+    std::array<LaneCoefficients, 2> current, target;
+    bool lanesDiffer = false;
+
+    //what startBand() found for this block, per lane and band
+    std::array<std::array<bool, numBands>, 2> bandRuns {}, stagesChanged {};
+
+    std::vector<ChannelState> channels;
+    bool idle = false;
+    bool shouldSnap = true;
+};